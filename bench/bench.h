@@ -0,0 +1,98 @@
+#pragma once
+#ifndef MYECS_BENCH_H
+#define MYECS_BENCH_H
+
+#include<algorithm>
+#include<chrono>
+#include<functional>
+#include<string>
+#include<string_view>
+#include<vector>
+#include"../src/types.h"
+
+//minimal benchmark harness, results are written as json by bench_main.cpp
+//a benchmark receives a State, does its setup, and wraps the measured part in start()/stop()
+
+namespace myecs::bench {
+
+	class State {
+	private:
+		using clock = std::chrono::steady_clock;
+
+		clock::time_point begin{};
+		clock::duration elapsed{};
+
+	public:
+		size_t size;
+		size_t ops = 0;
+
+		explicit State(size_t size) :size(size) {}
+
+		void start() {
+			begin = clock::now();
+		}
+
+		void stop() {
+			elapsed += clock::now() - begin;
+		}
+
+		MYECS_NODISCARD double nanoseconds()const {
+			return std::chrono::duration<double, std::nano>(elapsed).count();
+		}
+	};
+
+	struct Benchmark {
+		std::string name;
+		std::function<void(State&)> func;
+	};
+
+	inline std::vector<Benchmark>& registry() {
+		static std::vector<Benchmark> benchmarks;
+		return benchmarks;
+	}
+
+	struct Registrar {
+		Registrar(std::string_view name, void(*func)(State&)) {
+			registry().push_back({ std::string(name), func });
+		}
+	};
+
+	//deterministic permutation of [0, n) so accesses are not sequential
+	inline std::vector<size_t> shuffled(size_t n, types::u64 seed = 0x2545F4914F6CDD1Dull) {
+		std::vector<size_t> ret(n);
+		for (size_t i = 0; i < n; i++) {
+			ret[i] = i;
+		}
+		types::u64 state = seed;
+		for (size_t i = n; i > 1; i--) {
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			std::swap(ret[i - 1], ret[state % i]);
+		}
+		return ret;
+	}
+
+	//keeps the optimizer from dropping a computed value
+	template<class T>
+	inline void keep(T&& value) {
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile char sink;
+		sink = *reinterpret_cast<const volatile char*>(&value);
+#endif
+	}
+
+}//namespace myecs::bench
+
+#define MYECS_BENCH_CONCAT_IMPL(a, b) a##b
+#define MYECS_BENCH_CONCAT(a, b) MYECS_BENCH_CONCAT_IMPL(a, b)
+
+//MYECS_BENCHMARK(name) { ... state.start(); ...; state.stop(); state.ops = n; }
+#define MYECS_BENCHMARK(name) \
+	static void name(::myecs::bench::State&); \
+	static ::myecs::bench::Registrar MYECS_BENCH_CONCAT(name, _registrar)(#name, name); \
+	static void name([[maybe_unused]] ::myecs::bench::State& state)
+
+#endif
@@ -0,0 +1,204 @@
+#include"bench.h"
+#include"../src/dense_map.h"
+#include"../src/pool.h"
+
+using namespace myecs;
+using namespace myecs::bench;
+
+MYECS_BENCHMARK(int_vector_emplace_back) {
+	IntVector<size_t> v;
+	state.start();
+	for (size_t i = 0; i < state.size; i++) {
+		v.emplace_back(i);
+	}
+	state.stop();
+	state.ops = state.size;
+	keep(v.back());
+}
+
+MYECS_BENCHMARK(int_vector_force_get) {
+	IntVector<size_t> v;
+	auto order = shuffled(state.size);
+	state.start();
+	for (size_t i : order) {
+		v.force_get(i) = i;
+	}
+	state.stop();
+	state.ops = state.size;
+	keep(v.size());
+}
+
+MYECS_BENCHMARK(sparse_set_insert) {
+	SparseSet<entity> set;
+	state.start();
+	for (size_t i = 0; i < state.size; i++) {
+		set.insert(entity(static_cast<types::u32>(i), 0u));
+	}
+	state.stop();
+	state.ops = state.size;
+	keep(set.size());
+}
+
+MYECS_BENCHMARK(sparse_set_has) {
+	SparseSet<entity> set;
+	for (size_t i = 0; i < state.size; i += 2) {
+		set.insert(entity(static_cast<types::u32>(i), 0u));
+	}
+	auto order = shuffled(state.size);
+	size_t hits = 0;
+	state.start();
+	for (size_t i : order) {
+		hits += set.has(entity(static_cast<types::u32>(i), 0u));
+	}
+	state.stop();
+	state.ops = state.size;
+	keep(hits);
+}
+
+MYECS_BENCHMARK(sparse_set_erase) {
+	SparseSet<entity> set;
+	for (size_t i = 0; i < state.size; i++) {
+		set.insert(entity(static_cast<types::u32>(i), 0u));
+	}
+	auto order = shuffled(state.size);
+	state.start();
+	for (size_t i : order) {
+		set.erase(entity(static_cast<types::u32>(i), 0u));
+	}
+	state.stop();
+	state.ops = state.size;
+	keep(set.size());
+}
+
+//dense iteration with 64 and 32 bit handles, the compact dense array is half the bytes
+namespace {
+	template<class Entity>
+	void sparse_set_iterate(State& state) {
+		SparseSet<Entity> set;
+		for (size_t i : shuffled(state.size)) {
+			set.insert(Entity(i, 0u));
+		}
+		size_t sum = 0;
+		state.start();
+		for (size_t round = 0; round < 8; round++) {
+			for (Entity e : set) {
+				sum += e.get_id();
+			}
+		}
+		state.stop();
+		state.ops = state.size * 8;
+		keep(sum);
+	}
+}
+
+MYECS_BENCHMARK(sparse_set_iterate_default_entity) {
+	sparse_set_iterate<basic_entity<default_entity_traits>>(state);
+}
+
+MYECS_BENCHMARK(sparse_set_iterate_compact_entity) {
+	sparse_set_iterate<basic_entity<compact_entity_traits>>(state);
+}
+
+MYECS_BENCHMARK(id_gen_churn) {
+	IdGen<entity> ids;
+	IntVector<entity> live;
+	for (size_t i = 0; i < state.size; i++) {
+		live.emplace_back(ids.get());
+	}
+	state.start();
+	for (size_t round = 0; round < 4; round++) {
+		for (auto e : live) {
+			ids.ret(e);
+		}
+		for (size_t i = 0; i < live.size(); i++) {
+			live[i] = ids.get();
+		}
+	}
+	state.stop();
+	state.ops = state.size * 8;
+	keep(ids.count());
+}
+
+MYECS_BENCHMARK(dense_map_insert) {
+	DenseMap<size_t, size_t> map;
+	auto order = shuffled(state.size);
+	state.start();
+	for (size_t i : order) {
+		map[i] = i;
+	}
+	state.stop();
+	state.ops = state.size;
+	keep(map.size());
+}
+
+MYECS_BENCHMARK(dense_map_find) {
+	DenseMap<size_t, size_t> map;
+	for (size_t i = 0; i < state.size; i += 2) {
+		map[i] = i;
+	}
+	auto order = shuffled(state.size);
+	size_t hits = 0;
+	state.start();
+	for (size_t i : order) {
+		hits += map.contains(i);
+	}
+	state.stop();
+	state.ops = state.size;
+	keep(hits);
+}
+
+MYECS_BENCHMARK(dense_map_erase) {
+	DenseMap<size_t, size_t> map;
+	for (size_t i = 0; i < state.size; i++) {
+		map[i] = i;
+	}
+	auto order = shuffled(state.size);
+	state.start();
+	for (size_t i : order) {
+		map.erase(i);
+	}
+	state.stop();
+	state.ops = state.size;
+	keep(map.size());
+}
+
+MYECS_BENCHMARK(pool_create) {
+	pool::Pool<float> p;
+	state.start();
+	for (size_t i = 0; i < state.size; i++) {
+		keep(p.create(static_cast<float>(i)));
+	}
+	state.stop();
+	state.ops = state.size;
+}
+
+MYECS_BENCHMARK(pool_get) {
+	pool::Pool<float> p;
+	for (size_t i = 0; i < state.size; i++) {
+		p.create(static_cast<float>(i));
+	}
+	auto order = shuffled(state.size);
+	float sum = 0;
+	state.start();
+	for (size_t i : order) {
+		sum += p.get(i);
+	}
+	state.stop();
+	state.ops = state.size;
+	keep(sum);
+}
+
+MYECS_BENCHMARK(pool_churn) {
+	pool::Pool<float> p;
+	for (size_t i = 0; i < state.size; i++) {
+		p.create(static_cast<float>(i));
+	}
+	auto order = shuffled(state.size);
+	state.start();
+	for (size_t i : order) {
+		p.destroy(i);
+		keep(p.create(static_cast<float>(i)));
+	}
+	state.stop();
+	state.ops = state.size * 2;
+}
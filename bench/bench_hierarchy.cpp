@@ -0,0 +1,136 @@
+#include"bench.h"
+#include"../src/entity.h"
+
+using namespace myecs;
+using namespace myecs::bench;
+
+//world transform propagation over forests of `size` nodes split into `depth` levels,
+//every node picks a random parent on the level above. nodes and relations are created
+//in shuffled order, so pool order says nothing about the tree
+
+namespace {
+	struct Transform {
+		float local[3];
+		float world[3];
+	};
+
+	struct Parent {
+		entity value;
+	};
+
+	std::vector<entity> make_forest(Registry& reg, size_t n, size_t depth, bool hierarchy) {
+		std::vector<entity> nodes(n);
+		for (size_t i : shuffled(n, 7)) {
+			nodes[i] = reg.create();
+			reg.emplace<Transform>(nodes[i], Transform{ { 1.f, 2.f, 3.f }, {} });
+		}
+		size_t width = std::max<size_t>(n / depth, 1);
+		types::u64 state = 0x9E3779B97F4A7C15ull;
+		std::vector<size_t> parents(n, n);
+		for (size_t i = width; i < n; i++) {
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			parents[i] = (i / width - 1) * width + state % width;
+		}
+		for (size_t i : shuffled(n, 8)) {
+			entity parent = parents[i] == n ? null_entity : nodes[parents[i]];
+			if (hierarchy) {
+				reg.set_parent(nodes[i], parent);
+			}
+			else {
+				reg.emplace<Parent>(nodes[i], parent);
+			}
+		}
+		return nodes;
+	}
+
+	//walks up the Parent chain of every node in pool order
+	void propagate_naive(State& state, size_t depth) {
+		Registry reg;
+		make_forest(reg, state.size, depth, false);
+		state.start();
+		for (auto e : reg.view<Transform>()) {
+			Transform& t = reg.get<Transform>(e);
+			float world[3] = { t.local[0], t.local[1], t.local[2] };
+			for (entity p = reg.get<Parent>(e).value; p != null_entity; p = reg.get<Parent>(p).value) {
+				const Transform& pt = reg.get<Transform>(p);
+				for (size_t k = 0; k < 3; k++) {
+					world[k] += pt.local[k];
+				}
+			}
+			for (size_t k = 0; k < 3; k++) {
+				t.world[k] = world[k];
+			}
+		}
+		state.stop();
+		state.ops = state.size;
+	}
+
+	void propagate_hierarchy(State& state, size_t depth) {
+		Registry reg;
+		make_forest(reg, state.size, depth, true);
+		state.start();
+		reg.propagate<Transform>([](const Transform* parent, Transform& t) {
+			for (size_t k = 0; k < 3; k++) {
+				t.world[k] = t.local[k] + (parent ? parent->world[k] : 0.f);
+			}
+		});
+		state.stop();
+		state.ops = state.size;
+	}
+}
+
+MYECS_BENCHMARK(hierarchy_propagate_naive_depth_4) {
+	propagate_naive(state, 4);
+}
+
+MYECS_BENCHMARK(hierarchy_propagate_dfs_depth_4) {
+	propagate_hierarchy(state, 4);
+}
+
+MYECS_BENCHMARK(hierarchy_propagate_naive_depth_32) {
+	propagate_naive(state, 32);
+}
+
+MYECS_BENCHMARK(hierarchy_propagate_dfs_depth_32) {
+	propagate_hierarchy(state, 32);
+}
+
+MYECS_BENCHMARK(hierarchy_propagate_naive_depth_256) {
+	propagate_naive(state, 256);
+}
+
+MYECS_BENCHMARK(hierarchy_propagate_dfs_depth_256) {
+	propagate_hierarchy(state, 256);
+}
+
+//moving random leaves of a depth 32 forest under random other nodes
+MYECS_BENCHMARK(hierarchy_reparent_depth_32) {
+	Registry reg;
+	std::vector<entity> nodes = make_forest(reg, state.size, 32, true);
+	size_t moves = std::min<size_t>(state.size, 1000);
+	size_t width = std::max<size_t>(state.size / 32, 1);
+	std::vector<size_t> order = shuffled(state.size, 9);
+	state.start();
+	for (size_t i = 0; i < moves; i++) {
+		entity leaf = nodes[state.size - 1 - i % width];
+		reg.set_parent(leaf, nodes[order[i] % (state.size - width)]);
+	}
+	state.stop();
+	state.ops = moves;
+}
+
+//destroying every second node of a depth 32 forest with one bulk destroy
+MYECS_BENCHMARK(hierarchy_destroy_range_depth_32) {
+	Registry reg;
+	std::vector<entity> nodes = make_forest(reg, state.size, 32, true);
+	std::vector<entity> dead;
+	for (size_t i = 0; i < nodes.size(); i += 2) {
+		dead.push_back(nodes[i]);
+	}
+	state.start();
+	reg.destroy(dead.begin(), dead.end());
+	state.stop();
+	state.ops = dead.size();
+}
@@ -0,0 +1,262 @@
+#include"bench.h"
+#include"../src/entity.h"
+
+using namespace myecs;
+using namespace myecs::bench;
+
+//system kernels: per entity access against contiguous spans, aos against soa storage
+
+namespace {
+	//same layout twice, the second one opts into soa storage
+	struct Transform {
+		float x, y, z, rx, ry, rz;
+	};
+
+	struct SoaTransform {
+		float x, y, z, rx, ry, rz;
+	};
+}
+
+template<>
+struct myecs::soa_traits<SoaTransform> :myecs::soa_layout<&SoaTransform::x, &SoaTransform::y, &SoaTransform::z,
+															&SoaTransform::rx, &SoaTransform::ry, &SoaTransform::rz> {};
+
+namespace {
+	struct Position {
+		float x, y, z;
+	};
+
+	struct Velocity {
+		float x, y, z;
+	};
+
+	struct Health {
+		float value;
+	};
+
+	constexpr float dt = 1.f / 60.f;
+
+	//every pool is filled in its own random order, so dense arrays, storage slots and ids disagree
+	void populate_scrambled(Registry& reg, size_t n) {
+		std::vector<entity> entities;
+		for (size_t i = 0; i < n; i++) {
+			entities.push_back(reg.create());
+		}
+		for (size_t i : shuffled(n, 1)) {
+			reg.emplace<Position>(entities[i], 0.f, 0.f, 0.f);
+		}
+		for (size_t i : shuffled(n, 2)) {
+			reg.emplace<Velocity>(entities[i], 1.f, 2.f, 3.f);
+		}
+		for (size_t i : shuffled(n, 3)) {
+			reg.emplace<Health>(entities[i], 1.f);
+		}
+	}
+
+	void each_scrambled(State& state, size_t prefetch_distance) {
+		Registry reg;
+		populate_scrambled(reg, state.size);
+		state.start();
+		reg.each<Position, Velocity, Health>([](entity, Position& p, Velocity& v, Health& h) {
+			p.x += v.x * dt * h.value;
+			p.y += v.y * dt * h.value;
+			p.z += v.z * dt * h.value;
+		}, prefetch_distance);
+		state.stop();
+		state.ops = state.size;
+	}
+
+	void populate(Registry& reg, size_t n) {
+		for (size_t i = 0; i < n; i++) {
+			entity e = reg.create();
+			reg.emplace<Position>(e, 0.f, 0.f, 0.f);
+			reg.emplace<Velocity>(e, 1.f, 2.f, 3.f);
+		}
+	}
+}
+
+MYECS_BENCHMARK(kernel_integrate_per_entity) {
+	Registry reg;
+	populate(reg, state.size);
+	state.start();
+	for (auto e : reg.view<Position, Velocity>()) {
+		auto [p, v] = reg.get<Position, Velocity>(e);
+		p.x += v.x * dt;
+		p.y += v.y * dt;
+		p.z += v.z * dt;
+	}
+	state.stop();
+	state.ops = state.size;
+	keep(reg.get<Position>(*reg.view<Position>().begin()).x);
+}
+
+MYECS_BENCHMARK(kernel_integrate_span) {
+	Registry reg;
+	populate(reg, state.size);
+	state.start();
+	reg.each_span<Position, Velocity>([](std::span<const entity>, std::span<Position> p, std::span<Velocity> v) {
+		for (size_t i = 0; i < p.size(); i++) {
+			p[i].x += v[i].x * dt;
+			p[i].y += v[i].y * dt;
+			p[i].z += v[i].z * dt;
+		}
+	});
+	state.stop();
+	state.ops = state.size;
+	keep(reg.get<Position>(*reg.view<Position>().begin()).x);
+}
+
+//translation only touches x, y, z: half of every aos cache line is wasted
+MYECS_BENCHMARK(kernel_translate_aos) {
+	Registry reg;
+	for (size_t i = 0; i < state.size; i++) {
+		reg.emplace<Transform>(reg.create(), 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+	}
+	state.start();
+	reg.each_span<Transform>([](std::span<const entity>, std::span<Transform> t) {
+		for (auto& v : t) {
+			v.x += dt;
+			v.y += dt;
+			v.z += dt;
+		}
+	});
+	state.stop();
+	state.ops = state.size;
+}
+
+MYECS_BENCHMARK(kernel_translate_soa) {
+	Registry reg;
+	for (size_t i = 0; i < state.size; i++) {
+		reg.emplace<SoaTransform>(reg.create(), 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+	}
+	state.start();
+	reg.each_span<SoaTransform>([](std::span<const entity>, std::span<float> x, std::span<float> y, std::span<float> z, auto...) {
+		for (size_t i = 0; i < x.size(); i++) {
+			x[i] += dt;
+			y[i] += dt;
+			z[i] += dt;
+		}
+	});
+	state.stop();
+	state.ops = state.size;
+}
+
+MYECS_BENCHMARK(kernel_scrambled_view_get) {
+	Registry reg;
+	populate_scrambled(reg, state.size);
+	state.start();
+	for (auto e : reg.view<Position, Velocity, Health>()) {
+		auto [p, v, h] = reg.get<Position, Velocity, Health>(e);
+		p.x += v.x * dt * h.value;
+		p.y += v.y * dt * h.value;
+		p.z += v.z * dt * h.value;
+	}
+	state.stop();
+	state.ops = state.size;
+}
+
+MYECS_BENCHMARK(kernel_scrambled_each_no_prefetch) {
+	each_scrambled(state, 0);
+}
+
+MYECS_BENCHMARK(kernel_scrambled_each_prefetch_4) {
+	each_scrambled(state, 4);
+}
+
+MYECS_BENCHMARK(kernel_scrambled_each_prefetch_16) {
+	each_scrambled(state, 16);
+}
+
+MYECS_BENCHMARK(kernel_scrambled_each_prefetch_64) {
+	each_scrambled(state, 64);
+}
+
+MYECS_BENCHMARK(kernel_scrambled_each_prefetch_auto) {
+	each_scrambled(state, Registry::auto_prefetch);
+}
+
+//same work as kernel_scrambled_each, split into frames of 1024 entities by a resumable cursor
+MYECS_BENCHMARK(kernel_cursor_budget_1024) {
+	Registry reg;
+	populate_scrambled(reg, state.size);
+	ViewCursor<Position, Velocity, Health> cursor;
+	state.start();
+	while (cursor.passes() == 0) {
+		reg.resume(cursor, CursorBudget{ 1024 }, [](entity, Position& p, Velocity& v, Health& h) {
+			p.x += v.x * dt * h.value;
+			p.y += v.y * dt * h.value;
+			p.z += v.z * dt * h.value;
+		});
+	}
+	state.stop();
+	state.ops = state.size;
+}
+
+//a ring of cells where every eighth cell relaxes towards its neighbours each frame. the update must
+//read the values the frame started with, either from a snapshot of the whole pool taken before the
+//frame or from the previous buffer of a double buffered component. ops are frames of `size` cells
+namespace {
+	struct Cell {
+		float value;
+	};
+
+	struct BufferedCell {
+		float value;
+	};
+}
+
+template<>
+struct myecs::double_buffer_traits<BufferedCell> :std::true_type {};
+
+namespace {
+	constexpr size_t cell_frames = 16;
+	constexpr size_t cell_stride = 8;
+
+	template<class T>
+	std::vector<entity> make_cells(Registry& reg, size_t n) {
+		std::vector<entity> cells(n);
+		for (size_t i = 0; i < n; i++) {
+			cells[i] = reg.create();
+			reg.emplace<T>(cells[i], T{ float(i % 17) });
+		}
+		return cells;
+	}
+}
+
+MYECS_BENCHMARK(kernel_cells_snapshot) {
+	Registry reg;
+	std::vector<entity> cells = make_cells<Cell>(reg, state.size);
+	std::vector<float> snapshot(state.size);
+	size_t n = state.size;
+	state.start();
+	for (size_t frame = 0; frame < cell_frames; frame++) {
+		for (size_t i = 0; i < n; i++) {
+			snapshot[i] = reg.get<Cell>(cells[i]).value;
+		}
+		for (size_t i = frame % cell_stride; i < n; i += cell_stride) {
+			float around = snapshot[(i + n - 1) % n] + snapshot[(i + 1) % n];
+			reg.get<Cell>(cells[i]).value = 0.5f * snapshot[i] + 0.25f * around;
+		}
+	}
+	state.stop();
+	keep(reg.get<Cell>(cells[0]).value);
+	state.ops = cell_frames;
+}
+
+MYECS_BENCHMARK(kernel_cells_double_buffered) {
+	Registry reg;
+	std::vector<entity> cells = make_cells<BufferedCell>(reg, state.size);
+	size_t n = state.size;
+	state.start();
+	for (size_t frame = 0; frame < cell_frames; frame++) {
+		for (size_t i = frame % cell_stride; i < n; i += cell_stride) {
+			float around = reg.previous<BufferedCell>(cells[(i + n - 1) % n]).value +
+				reg.previous<BufferedCell>(cells[(i + 1) % n]).value;
+			reg.get<BufferedCell>(cells[i]).value = 0.5f * reg.previous<BufferedCell>(cells[i]).value + 0.25f * around;
+		}
+		reg.swap_buffers<BufferedCell>();
+	}
+	state.stop();
+	keep(reg.get<BufferedCell>(cells[0]).value);
+	state.ops = cell_frames;
+}
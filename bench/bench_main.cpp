@@ -0,0 +1,103 @@
+#include<cstdio>
+#include<cstdlib>
+#include<cstring>
+#include"bench.h"
+#include"../src/profile.h"
+#ifdef MYECS_PROFILE
+#include<iostream>
+#endif
+
+//usage: myecs_bench [--size N] [--reps R] [--filter substring] [--out file.json]
+//every benchmark runs R times on a fresh State, the json holds the fastest and the median run
+
+namespace {
+	using namespace myecs::bench;
+
+	struct Result {
+		std::string name;
+		size_t size = 0;
+		size_t ops = 0;
+		std::vector<double> ns{};
+	};
+
+	void write_json(std::FILE* out, const std::vector<Result>& results, size_t reps) {
+#if defined(__clang__)
+		const char* compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+		const char* compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+		const char* compiler = "msvc";
+#else
+		const char* compiler = "unknown";
+#endif
+		std::fprintf(out, "{\n  \"suite\": \"myecs_bench\",\n  \"compiler\": \"%s\",\n  \"debug_level\": %d,\n  \"repetitions\": %zu,\n  \"results\": [",
+					 compiler, myecs::myecs_debug_level, reps);
+		for (size_t i = 0; i < results.size(); i++) {
+			const Result& r = results[i];
+			std::vector<double> sorted = r.ns;
+			std::sort(sorted.begin(), sorted.end());
+			double ops = static_cast<double>(std::max<size_t>(r.ops, 1));
+			std::fprintf(out, "%s\n    {\"name\": \"%s\", \"size\": %zu, \"ops\": %zu, \"min_ns\": %.0f, \"median_ns\": %.0f, \"min_ns_per_op\": %.3f, \"median_ns_per_op\": %.3f}",
+						 i ? "," : "", r.name.c_str(), r.size, r.ops,
+						 sorted.front(), sorted[sorted.size() / 2],
+						 sorted.front() / ops, sorted[sorted.size() / 2] / ops);
+		}
+		std::fprintf(out, "\n  ]\n}\n");
+	}
+}
+
+int main(int argc, char** argv) {
+	size_t size = 100'000;
+	size_t reps = 5;
+	const char* filter = "";
+	const char* out_path = nullptr;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (!std::strcmp(argv[i], "--size")) {
+			size = std::strtoull(argv[i + 1], nullptr, 10);
+		}
+		else if (!std::strcmp(argv[i], "--reps")) {
+			reps = std::max<size_t>(1, std::strtoull(argv[i + 1], nullptr, 10));
+		}
+		else if (!std::strcmp(argv[i], "--filter")) {
+			filter = argv[i + 1];
+		}
+		else if (!std::strcmp(argv[i], "--out")) {
+			out_path = argv[i + 1];
+		}
+		else {
+			std::fprintf(stderr, "unknown option %s\n", argv[i]);
+			return 1;
+		}
+	}
+
+	std::vector<Result> results;
+	for (const Benchmark& b : registry()) {
+		if (b.name.find(filter) == std::string::npos) {
+			continue;
+		}
+		Result r{ b.name, size };
+		for (size_t i = 0; i < reps; i++) {
+			State state(size);
+			b.func(state);
+			r.ops = state.ops;
+			r.ns.push_back(state.nanoseconds());
+		}
+		std::fprintf(stderr, "%-40s %10.3f ns/op\n", r.name.c_str(),
+					 *std::min_element(r.ns.begin(), r.ns.end()) / static_cast<double>(std::max<size_t>(r.ops, 1)));
+		results.push_back(std::move(r));
+	}
+
+	std::FILE* out = out_path ? std::fopen(out_path, "w") : stdout;
+	if (!out) {
+		std::fprintf(stderr, "cannot open %s\n", out_path);
+		return 1;
+	}
+	write_json(out, results, reps);
+	if (out != stdout) {
+		std::fclose(out);
+	}
+#ifdef MYECS_PROFILE
+	myecs::profile::write_summary(std::cerr);
+#endif
+	return 0;
+}
@@ -0,0 +1,866 @@
+#include"bench.h"
+#include"../src/entity.h"
+#include"../src/mapped_registry.h"
+#include"../src/static_registry.h"
+#include<any>
+#include<array>
+#include<cstdio>
+
+using namespace myecs;
+using namespace myecs::bench;
+
+namespace {
+	struct Position {
+		float x, y, z;
+	};
+
+	struct Velocity {
+		float x, y, z;
+	};
+
+	struct Health {
+		int value;
+	};
+
+	struct Owner {
+		size_t player_id;
+	};
+
+	template<size_t N>
+	struct Tag {
+		size_t value;
+	};
+
+	//every entity has Position, every second Velocity, every third Health
+	void populate(Registry& reg, size_t n) {
+		for (size_t i = 0; i < n; i++) {
+			entity e = reg.create();
+			reg.emplace<Position>(e, 1.f, 2.f, 3.f);
+			if (i % 2 == 0) {
+				reg.emplace<Velocity>(e, 1.f, 0.f, 0.f);
+			}
+			if (i % 3 == 0) {
+				reg.emplace<Health>(e, 100);
+			}
+		}
+	}
+
+	//every entity has Tag<0..4> with a different probability, the intersection keeps about 40%
+	void populate_tags(Registry& reg, size_t n) {
+		for (size_t i = 0; i < n; i++) {
+			entity e = reg.create();
+			reg.emplace<Tag<0>>(e, i);
+			if (i % 10 != 0) reg.emplace<Tag<1>>(e, i);
+			if (i % 5 != 1) reg.emplace<Tag<2>>(e, i);
+			if (i % 4 != 2) reg.emplace<Tag<3>>(e, i);
+			if (i % 3 != 0) reg.emplace<Tag<4>>(e, i);
+		}
+	}
+
+	template<size_t ...I>
+	Prefab make_prefab(std::index_sequence<I...>) {
+		Prefab prefab;
+		(prefab.set<Tag<I>>(I), ...);
+		return prefab;
+	}
+
+	//1000 entities per player
+	void populate_owners(Registry& reg, size_t n) {
+		for (size_t i = 0; i < n; i++) {
+			reg.emplace<Owner>(reg.create(), i % std::max<size_t>(n / 1000, 1));
+		}
+	}
+
+	constexpr size_t owner_lookups = 1000;
+
+	template<size_t ...I>
+	void emplace_tags(Registry& reg, entity e, std::index_sequence<I...>) {
+		(reg.emplace<Tag<I>>(e, I), ...);
+	}
+
+	template<size_t N>
+	void destroy_with_components(State& state) {
+		Registry reg;
+		IntVector<entity> entities;
+		for (size_t i = 0; i < state.size; i++) {
+			entity e = reg.create();
+			emplace_tags(reg, e, std::make_index_sequence<N>{});
+			entities.emplace_back(e);
+		}
+		state.start();
+		for (auto e : entities) {
+			reg.destroy(e);
+		}
+		state.stop();
+		state.ops = state.size;
+		keep(reg.entity_count());
+	}
+}
+
+MYECS_BENCHMARK(registry_create) {
+	Registry reg;
+	state.start();
+	for (size_t i = 0; i < state.size; i++) {
+		keep(reg.create());
+	}
+	state.stop();
+	state.ops = state.size;
+}
+
+MYECS_BENCHMARK(registry_create_destroy_churn) {
+	Registry reg;
+	IntVector<entity> entities;
+	for (size_t i = 0; i < state.size; i++) {
+		entity e = reg.create();
+		reg.emplace<Position>(e, 0.f, 0.f, 0.f);
+		entities.emplace_back(e);
+	}
+	state.start();
+	for (size_t i = 0; i < entities.size(); i++) {
+		reg.destroy(entities[i]);
+		entities[i] = reg.create();
+		reg.emplace<Position>(entities[i], 0.f, 0.f, 0.f);
+	}
+	state.stop();
+	state.ops = state.size;
+	keep(reg.entity_count());
+}
+
+MYECS_BENCHMARK(registry_emplace) {
+	Registry reg;
+	IntVector<entity> entities;
+	for (size_t i = 0; i < state.size; i++) {
+		entities.emplace_back(reg.create());
+	}
+	state.start();
+	for (auto e : entities) {
+		reg.emplace<Position>(e, 1.f, 2.f, 3.f);
+	}
+	state.stop();
+	state.ops = state.size;
+	keep(reg.component_count());
+}
+
+MYECS_BENCHMARK(registry_get) {
+	Registry reg;
+	populate(reg, state.size);
+	IntVector<entity> entities;
+	for (auto e : reg.view<Position>()) {
+		entities.emplace_back(e);
+	}
+	float sum = 0;
+	state.start();
+	for (auto e : entities) {
+		sum += reg.get<Position>(e).x;
+	}
+	state.stop();
+	state.ops = state.size;
+	keep(sum);
+}
+
+MYECS_BENCHMARK(registry_view_1) {
+	Registry reg;
+	populate(reg, state.size);
+	float sum = 0;
+	state.start();
+	for (auto e : reg.view<Position>()) {
+		sum += reg.get<Position>(e).x;
+	}
+	state.stop();
+	state.ops = state.size;
+	keep(sum);
+}
+
+MYECS_BENCHMARK(registry_view_2) {
+	Registry reg;
+	populate(reg, state.size);
+	float sum = 0;
+	state.start();
+	for (auto e : reg.view<Position, Velocity>()) {
+		auto [p, v] = reg.get<Position, Velocity>(e);
+		sum += p.x + v.x;
+	}
+	state.stop();
+	state.ops = state.size;
+	keep(sum);
+}
+
+MYECS_BENCHMARK(registry_view_3) {
+	Registry reg;
+	populate(reg, state.size);
+	float sum = 0;
+	state.start();
+	for (auto e : reg.view<Position, Velocity, Health>()) {
+		auto [p, v, h] = reg.get<Position, Velocity, Health>(e);
+		sum += p.x + v.x + static_cast<float>(h.value);
+	}
+	state.stop();
+	state.ops = state.size;
+	keep(sum);
+}
+
+MYECS_BENCHMARK(registry_view_5_probe) {
+	Registry reg;
+	populate_tags(reg, state.size);
+	state.start();
+	auto result = reg.view<Tag<0>, Tag<1>, Tag<2>, Tag<3>, Tag<4>>(QueryStrategy::probe);
+	state.stop();
+	state.ops = state.size;
+	keep(result.size());
+}
+
+MYECS_BENCHMARK(registry_view_5_bitmap) {
+	Registry reg;
+	populate_tags(reg, state.size);
+	state.start();
+	auto result = reg.bitmap_view<Tag<0>, Tag<1>, Tag<2>, Tag<3>, Tag<4>>();
+	state.stop();
+	state.ops = state.size;
+	keep(result.size());
+}
+
+MYECS_BENCHMARK(registry_view_5_planned) {
+	Registry reg;
+	populate_tags(reg, state.size);
+	state.start();
+	auto result = reg.view<Tag<0>, Tag<1>, Tag<2>, Tag<3>, Tag<4>>();
+	state.stop();
+	state.ops = state.size;
+	keep(result.size());
+}
+
+//reading the matches of a persistent query: no intersection left to do
+MYECS_BENCHMARK(registry_view_5_persistent) {
+	Registry reg;
+	populate_tags(reg, state.size);
+	(void)reg.persist<Tag<0>, Tag<1>, Tag<2>, Tag<3>, Tag<4>>();
+	size_t sum = 0;
+	state.start();
+	for (auto e : reg.persistent_view<Tag<0>, Tag<1>, Tag<2>, Tag<3>, Tag<4>>()) {
+		sum += e.get_id();
+	}
+	state.stop();
+	state.ops = state.size;
+	keep(sum);
+}
+
+//the write side: every emplace of a Tag<N> tests the component set of the entity
+MYECS_BENCHMARK(registry_populate_5_persistent) {
+	Registry reg;
+	(void)reg.persist<Tag<0>, Tag<1>, Tag<2>, Tag<3>, Tag<4>>();
+	state.start();
+	populate_tags(reg, state.size);
+	state.stop();
+	state.ops = state.size;
+}
+
+MYECS_BENCHMARK(registry_populate_5) {
+	Registry reg;
+	state.start();
+	populate_tags(reg, state.size);
+	state.stop();
+	state.ops = state.size;
+}
+
+MYECS_BENCHMARK(registry_view_exclude_manual) {
+	Registry reg;
+	populate_tags(reg, state.size);
+	size_t matches = 0;
+	state.start();
+	for (auto e : reg.view<Tag<0>, Tag<1>>()) {
+		if (!reg.has<Tag<3>>(e) && !reg.has<Tag<4>>(e)) {
+			matches++;
+		}
+	}
+	state.stop();
+	state.ops = state.size;
+	keep(matches);
+}
+
+MYECS_BENCHMARK(registry_view_exclude) {
+	Registry reg;
+	populate_tags(reg, state.size);
+	state.start();
+	auto result = reg.view<Tag<0>, Tag<1>>(exclude<Tag<3>, Tag<4>>);
+	state.stop();
+	state.ops = state.size;
+	keep(result.size());
+}
+
+MYECS_BENCHMARK(registry_destroy_1_component) {
+	destroy_with_components<1>(state);
+}
+
+MYECS_BENCHMARK(registry_destroy_4_components) {
+	destroy_with_components<4>(state);
+}
+
+MYECS_BENCHMARK(registry_destroy_8_components) {
+	destroy_with_components<8>(state);
+}
+
+MYECS_BENCHMARK(registry_lookup_scan) {
+	Registry reg;
+	populate_owners(reg, state.size);
+	size_t found = 0;
+	state.start();
+	for (size_t k = 0; k < owner_lookups / 100; k++) {
+		for (auto e : reg.view<Owner>()) {
+			found += reg.get<Owner>(e).player_id == k;
+		}
+	}
+	state.stop();
+	state.ops = owner_lookups / 100;
+	keep(found);
+}
+
+MYECS_BENCHMARK(registry_lookup_hash_index) {
+	Registry reg;
+	populate_owners(reg, state.size);
+	(void)reg.hash_index<&Owner::player_id>();
+	size_t found = 0;
+	state.start();
+	for (size_t k = 0; k < owner_lookups; k++) {
+		found += reg.find_by<&Owner::player_id>(k).size();
+	}
+	state.stop();
+	state.ops = owner_lookups;
+	keep(found);
+}
+
+MYECS_BENCHMARK(registry_lookup_ordered_index) {
+	Registry reg;
+	populate_owners(reg, state.size);
+	(void)reg.ordered_index<&Owner::player_id>();
+	size_t found = 0;
+	state.start();
+	for (size_t k = 0; k < owner_lookups; k++) {
+		found += reg.find_range<&Owner::player_id>(k, k).size();
+	}
+	state.stop();
+	state.ops = owner_lookups;
+	keep(found);
+}
+
+//index upkeep on the write side: emplace with and without a hash index
+MYECS_BENCHMARK(registry_emplace_indexed) {
+	Registry reg;
+	(void)reg.hash_index<&Owner::player_id>();
+	state.start();
+	populate_owners(reg, state.size);
+	state.stop();
+	state.ops = state.size;
+}
+
+MYECS_BENCHMARK(registry_patch_indexed) {
+	Registry reg;
+	populate_owners(reg, state.size);
+	(void)reg.hash_index<&Owner::player_id>();
+	state.start();
+	for (auto e : reg.view<Owner>()) {
+		reg.patch<Owner>(e, [](Owner& o) {
+			o.player_id++;
+		});
+	}
+	state.stop();
+	state.ops = state.size;
+}
+
+//spawning a 12 component monster
+MYECS_BENCHMARK(registry_spawn_12_emplace) {
+	Registry reg;
+	state.start();
+	for (size_t i = 0; i < state.size; i++) {
+		emplace_tags(reg, reg.create(), std::make_index_sequence<12>{});
+	}
+	state.stop();
+	state.ops = state.size;
+}
+
+MYECS_BENCHMARK(registry_spawn_12_prefab) {
+	Registry reg;
+	Prefab prefab = make_prefab(std::make_index_sequence<12>{});
+	state.start();
+	auto entities = reg.instantiate(prefab, state.size);
+	state.stop();
+	state.ops = state.size;
+	keep(entities.size());
+}
+
+//spawning into a fresh registry, growing every array on the way or reserved up front (untimed)
+namespace {
+	void spawn_3(State& state, bool reserved) {
+		Registry reg;
+		if (reserved) {
+			reg.reserve<Position>(state.size);
+			reg.reserve<Velocity>(state.size);
+			reg.reserve<Health>(state.size);
+			reg.reserve(state.size, 3);
+		}
+		state.start();
+		for (size_t i = 0; i < state.size; i++) {
+			entity e = reg.create();
+			reg.emplace<Position>(e, 0.f, 0.f, 0.f);
+			reg.emplace<Velocity>(e, 0.f, 0.f, 0.f);
+			reg.emplace<Health>(e, 100);
+		}
+		state.stop();
+		state.ops = state.size;
+	}
+}
+
+MYECS_BENCHMARK(registry_spawn_3_grow) {
+	spawn_3(state, false);
+}
+
+MYECS_BENCHMARK(registry_spawn_3_reserved) {
+	spawn_3(state, true);
+}
+
+//after a spike nine entities in ten are gone, the rest sit all over the storage and id range
+namespace {
+	void spike(Registry& reg, size_t n) {
+		std::vector<entity> entities(n);
+		for (size_t i = 0; i < n; i++) {
+			entities[i] = reg.create();
+			reg.emplace<Position>(entities[i], 0.f, 0.f, 0.f);
+			reg.emplace<Velocity>(entities[i], 0.f, 0.f, 0.f);
+			reg.emplace<Health>(entities[i], 100);
+		}
+		for (size_t i : shuffled(n, 5)) {
+			if (i % 10) {
+				reg.destroy(entities[i]);
+			}
+		}
+	}
+}
+
+MYECS_BENCHMARK(registry_compact_after_spike) {
+	Registry reg;
+	spike(reg, state.size);
+	state.start();
+	reg.compact();
+	state.stop();
+	state.ops = reg.entity_count();
+}
+
+MYECS_BENCHMARK(registry_renumber_after_spike) {
+	Registry reg;
+	spike(reg, state.size);
+	size_t moved = 0;
+	state.start();
+	reg.renumber([&](entity, entity) {
+		moved++;
+	});
+	state.stop();
+	keep(moved);
+	state.ops = reg.entity_count();
+}
+
+//end of a wave: every projectile expires at once, then every second one
+MYECS_BENCHMARK(registry_destroy_wave_loop) {
+	Registry reg;
+	populate(reg, state.size);
+	std::vector<entity> entities(reg.view<Position>().begin(), reg.view<Position>().end());
+	state.start();
+	for (entity e : entities) {
+		reg.destroy(e);
+	}
+	state.stop();
+	state.ops = state.size;
+}
+
+MYECS_BENCHMARK(registry_destroy_wave_bulk) {
+	Registry reg;
+	populate(reg, state.size);
+	state.start();
+	reg.destroy_all(reg.view<Position>());
+	state.stop();
+	state.ops = state.size;
+}
+
+MYECS_BENCHMARK(registry_destroy_half_loop) {
+	Registry reg;
+	populate(reg, state.size);
+	IntVector<entity> entities;
+	for (entity e : reg.view<Position>()) {
+		if (e.get_id() % 2) {
+			entities.emplace_back(e);
+		}
+	}
+	state.start();
+	for (entity e : entities) {
+		reg.destroy(e);
+	}
+	state.stop();
+	state.ops = entities.size();
+}
+
+MYECS_BENCHMARK(registry_destroy_half_bulk) {
+	Registry reg;
+	populate(reg, state.size);
+	IntVector<entity> entities;
+	for (entity e : reg.view<Position>()) {
+		if (e.get_id() % 2) {
+			entities.emplace_back(e);
+		}
+	}
+	state.start();
+	reg.destroy(entities.begin(), entities.end());
+	state.stop();
+	state.ops = entities.size();
+}
+
+//the same spawn, iterate, despawn cycle on Registry and on StaticRegistry
+namespace {
+	using StaticWorld = StaticRegistry<Position, Velocity, Health, Tag<0>, Tag<1>, Tag<2>, Tag<3>, Tag<4>>;
+
+	template<class World>
+	void spawn(World& reg, size_t n) {
+		for (size_t i = 0; i < n; i++) {
+			entity e = reg.create();
+			reg.template emplace<Position>(e, 1.f, 2.f, 3.f);
+			if (i % 2 == 0) {
+				reg.template emplace<Velocity>(e, 1.f, 0.f, 0.f);
+			}
+			if (i % 3 == 0) {
+				reg.template emplace<Health>(e, 100);
+			}
+		}
+	}
+
+	template<class World>
+	void world_spawn(State& state) {
+		World reg;
+		state.start();
+		spawn(reg, state.size);
+		state.stop();
+		state.ops = state.size;
+	}
+
+	template<class World>
+	void world_each(State& state) {
+		World reg;
+		spawn(reg, state.size);
+		state.start();
+		reg.template each<Position, Velocity>([](entity, Position& p, Velocity& v) {
+			p.x += v.x;
+		});
+		state.stop();
+		state.ops = state.size;
+	}
+
+	template<class World>
+	void world_destroy(State& state) {
+		World reg;
+		spawn(reg, state.size);
+		IntVector<entity> entities;
+		for (entity e : reg.template view<Position>()) {
+			entities.emplace_back(e);
+		}
+		state.start();
+		for (entity e : entities) {
+			reg.destroy(e);
+		}
+		state.stop();
+		state.ops = state.size;
+	}
+}
+
+MYECS_BENCHMARK(world_spawn_dynamic) {
+	world_spawn<Registry>(state);
+}
+
+MYECS_BENCHMARK(world_spawn_static) {
+	world_spawn<StaticWorld>(state);
+}
+
+MYECS_BENCHMARK(world_each_dynamic) {
+	world_each<Registry>(state);
+}
+
+MYECS_BENCHMARK(world_each_static) {
+	world_each<StaticWorld>(state);
+}
+
+MYECS_BENCHMARK(world_destroy_dynamic) {
+	world_destroy<Registry>(state);
+}
+
+MYECS_BENCHMARK(world_destroy_static) {
+	world_destroy<StaticWorld>(state);
+}
+
+//a 32 byte component defined by a script: boxed in std::any (one heap block per instance)
+//or registered as a runtime component type
+namespace {
+	using ScriptData = std::array<float, 8>;
+
+	struct Boxed {
+		std::any value;
+	};
+
+	pool::TypeInfo script_type() {
+		pool::TypeInfo ret;
+		ret.name = "ScriptData";
+		ret.size = sizeof(ScriptData);
+		ret.alignment = alignof(ScriptData);
+		return ret;
+	}
+}
+
+MYECS_BENCHMARK(script_spawn_boxed) {
+	Registry reg;
+	state.start();
+	for (size_t i = 0; i < state.size; i++) {
+		entity e = reg.create();
+		reg.emplace<Boxed>(e, Boxed{ ScriptData{ float(i) } });
+	}
+	state.stop();
+	state.ops = state.size;
+}
+
+MYECS_BENCHMARK(script_spawn_runtime) {
+	Registry reg;
+	id_type cid = reg.add_component(script_type());
+	state.start();
+	for (size_t i = 0; i < state.size; i++) {
+		entity e = reg.create();
+		ScriptData data{ float(i) };
+		reg.emplace(e, cid, &data);
+	}
+	state.stop();
+	state.ops = state.size;
+}
+
+MYECS_BENCHMARK(script_each_boxed) {
+	Registry reg;
+	for (size_t i = 0; i < state.size; i++) {
+		entity e = reg.create();
+		reg.emplace<Boxed>(e, Boxed{ ScriptData{ float(i) } });
+	}
+	float sum = 0.f;
+	state.start();
+	reg.each<Boxed>([&](entity, Boxed& b) {
+		sum += std::any_cast<ScriptData&>(b.value)[0];
+	});
+	state.stop();
+	keep(sum);
+	state.ops = state.size;
+}
+
+MYECS_BENCHMARK(script_each_runtime) {
+	Registry reg;
+	id_type cid = reg.add_component(script_type());
+	for (size_t i = 0; i < state.size; i++) {
+		entity e = reg.create();
+		ScriptData data{ float(i) };
+		reg.emplace(e, cid, &data);
+	}
+	std::array<id_type, 1> components = { cid };
+	float sum = 0.f;
+	state.start();
+	reg.each(components, [&](entity, std::span<void* const> values) {
+		sum += static_cast<const ScriptData*>(values[0])->at(0);
+	});
+	state.stop();
+	keep(sum);
+	state.ops = state.size;
+}
+
+//a quarter of the entities arrive as a shuffled list from outside (contacts, packets) and their
+//Position and Velocity are copied into contiguous buffers
+namespace {
+	struct BatchSetup {
+		Registry reg;
+		std::vector<entity> list;
+		std::vector<Position> positions;
+		std::vector<Velocity> velocities;
+
+		explicit BatchSetup(size_t n) {
+			std::vector<entity> entities(n);
+			for (size_t i = 0; i < n; i++) {
+				entities[i] = reg.create();
+				reg.emplace<Position>(entities[i], float(i), 0.f, 0.f);
+				reg.emplace<Velocity>(entities[i], 1.f, 0.f, 0.f);
+			}
+			for (size_t i : shuffled(n, 11)) {
+				if (list.size() == n / 4) {
+					break;
+				}
+				list.push_back(entities[i]);
+			}
+			positions.resize(list.size());
+			velocities.resize(list.size());
+		}
+	};
+}
+
+MYECS_BENCHMARK(batch_get_loop) {
+	BatchSetup s(state.size);
+	state.start();
+	for (size_t k = 0; k < s.list.size(); k++) {
+		s.positions[k] = s.reg.get<Position>(s.list[k]);
+		s.velocities[k] = s.reg.get<Velocity>(s.list[k]);
+	}
+	state.stop();
+	keep(s.positions.back().x);
+	state.ops = s.list.size();
+}
+
+MYECS_BENCHMARK(batch_gather) {
+	BatchSetup s(state.size);
+	state.start();
+	s.reg.gather<Position, Velocity>(s.list, s.positions.data(), s.velocities.data());
+	state.stop();
+	keep(s.positions.back().x);
+	state.ops = s.list.size();
+}
+
+//the list sorted once up front (untimed), as for a list that is gathered and scattered every frame
+MYECS_BENCHMARK(batch_gather_sorted) {
+	BatchSetup s(state.size);
+	s.reg.sort_by_storage<Position>(s.list);
+	state.start();
+	s.reg.gather<Position, Velocity>(s.list, s.positions.data(), s.velocities.data());
+	state.stop();
+	keep(s.positions.back().x);
+	state.ops = s.list.size();
+}
+
+MYECS_BENCHMARK(batch_sort_by_storage) {
+	BatchSetup s(state.size);
+	state.start();
+	s.reg.sort_by_storage<Position>(s.list);
+	state.stop();
+	keep(s.list[0]);
+	state.ops = s.list.size();
+}
+
+MYECS_BENCHMARK(batch_scatter) {
+	BatchSetup s(state.size);
+	state.start();
+	s.reg.scatter<Position, Velocity>(s.list, s.positions.data(), s.velocities.data());
+	state.stop();
+	keep(s.reg.get<Position>(s.list[0]).x);
+	state.ops = s.list.size();
+}
+
+//world startup: rebuilding a Registry from flat arrays, which is the floor for any deserializer,
+//against opening a world saved in a mapped file. the file sits in the page cache, so the mapped runs
+//measure the mapping and the page faults, not the disk. ops are the entities of the world
+namespace {
+	using MappedWorld = MappedRegistry<Position, Velocity>;
+
+	std::filesystem::path world_file(size_t n) {
+		std::filesystem::path path = std::filesystem::temp_directory_path() / "myecs_bench_world.bin";
+		std::filesystem::remove(path);
+		MappedWorld world(path, n);
+		for (size_t i = 0; i < n; i++) {
+			entity e = world.create();
+			world.emplace<Position>(e, float(i), 2.f, 3.f);
+			if (i % 2 == 0) {
+				world.emplace<Velocity>(e, 1.f, 0.f, 0.f);
+			}
+		}
+		world.flush();
+		return path;
+	}
+}
+
+MYECS_BENCHMARK(startup_load_registry) {
+	std::vector<Position> positions(state.size, Position{ 1.f, 2.f, 3.f });
+	std::vector<Velocity> velocities(state.size / 2 + 1, Velocity{ 1.f, 0.f, 0.f });
+	state.start();
+	Registry reg;
+	for (size_t i = 0; i < state.size; i++) {
+		entity e = reg.create();
+		reg.emplace<Position>(e, positions[i]);
+		if (i % 2 == 0) {
+			reg.emplace<Velocity>(e, velocities[i / 2]);
+		}
+	}
+	float sum = 0.f;
+	reg.each<Position>([&](entity, Position& p) {
+		sum += p.x;
+	});
+	state.stop();
+	keep(sum);
+	state.ops = state.size;
+}
+
+//open and read every Position, so every page of that array is faulted in
+MYECS_BENCHMARK(startup_open_mapped) {
+	std::filesystem::path path = world_file(state.size);
+	state.start();
+	MappedWorld world(path);
+	float sum = 0.f;
+	for (const Position& p : world.values<Position>()) {
+		sum += p.x;
+	}
+	state.stop();
+	keep(sum);
+	state.ops = state.size;
+	std::filesystem::remove(path);
+}
+
+//open and read 1000 entities, the rest of the file is never touched. ops are the reads, open included
+MYECS_BENCHMARK(startup_open_mapped_sparse_reads) {
+	std::filesystem::path path = world_file(state.size);
+	std::vector<size_t> order = shuffled(state.size, 11);
+	size_t reads = std::min<size_t>(state.size, 1000);
+	state.start();
+	MappedWorld world(path);
+	float sum = 0.f;
+	for (size_t i = 0; i < reads; i++) {
+		sum += world.get<Position>(world.view<Position>()[order[i]]).x;
+	}
+	state.stop();
+	keep(sum);
+	state.ops = reads;
+	std::filesystem::remove(path);
+}
+
+//a pass over `size` entities with Health that destroys every tenth one, as an expiry system would.
+//swap_and_pop sets need the dead collected first and destroyed after the pass
+namespace {
+	void populate_expiring(Registry& reg, size_t n) {
+		for (size_t i = 0; i < n; i++) {
+			entity e = reg.create();
+			reg.emplace<Health>(e, static_cast<int>(i % 10));
+			reg.emplace<Position>(e, 1.f, 2.f, 3.f);
+		}
+	}
+}
+
+MYECS_BENCHMARK(expire_collect_then_destroy) {
+	Registry reg;
+	populate_expiring(reg, state.size);
+	state.start();
+	std::vector<entity> dead;
+	reg.each<Health>([&](entity e, Health& h) {
+		if (h.value == 0) {
+			dead.push_back(e);
+		}
+	});
+	for (entity e : dead) {
+		reg.destroy(e);
+	}
+	state.stop();
+	state.ops = state.size;
+}
+
+MYECS_BENCHMARK(expire_destroy_in_place) {
+	Registry reg;
+	reg.set_deletion<Health>(DeletionPolicy::in_place());
+	populate_expiring(reg, state.size);
+	state.start();
+	reg.each<Health>([&](entity e, Health& h) {
+		if (h.value == 0) {
+			reg.destroy(e);
+		}
+	});
+	reg.sync();
+	state.stop();
+	state.ops = state.size;
+}
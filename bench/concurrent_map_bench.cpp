@@ -0,0 +1,116 @@
+#include<atomic>
+#include<chrono>
+#include<cstdio>
+#include<cstdlib>
+#include<thread>
+#include<vector>
+#include"../src/concurrent_map.h"
+
+//contention benchmark: ConcurrentDenseMap against a DenseMap behind one global reader/writer lock
+//usage: concurrent_map_bench [total_ops] [key_count]
+//prints one json object per run
+
+namespace {
+	using namespace myecs;
+	using asset_id = types::u64;
+
+	class GlobalLockMap {
+	private:
+		mutable std::shared_mutex mutex;
+		DenseMap<asset_id, entity> map;
+	public:
+		bool contains(asset_id key)const {
+			std::shared_lock lock(mutex);
+			return map.contains(key);
+		}
+
+		void insert_or_assign(asset_id key, entity e) {
+			std::unique_lock lock(mutex);
+			map[key] = e;
+		}
+	};
+
+	using ShardedMap = ConcurrentDenseMap<asset_id, entity>;
+
+	struct XorShift {
+		types::u64 state;
+		types::u64 operator()() {
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			return state;
+		}
+	};
+
+	template<class Map>
+	double run(Map& map, size_t threads, size_t total_ops, size_t keys, unsigned write_permille) {
+		std::atomic<size_t> ready = 0;
+		std::atomic<bool> go = false;
+		std::atomic<size_t> hits = 0;
+		std::vector<std::thread> workers;
+		size_t ops = total_ops / threads;
+		for (size_t t = 0; t < threads; t++) {
+			workers.emplace_back([&, t] {
+				XorShift rng{ 0x9E3779B97F4A7C15ull * (t + 1) };
+				size_t local_hits = 0;
+				ready++;
+				while (!go.load(std::memory_order_acquire)) {
+					std::this_thread::yield();
+				}
+				for (size_t i = 0; i < ops; i++) {
+					types::u64 r = rng();
+					asset_id key = (r >> 16) % keys;
+					if ((r & 0xFFFF) % 1000 < write_permille) {
+						map.insert_or_assign(key, entity(static_cast<types::u32>(key), static_cast<types::u32>(i)));
+					}
+					else {
+						local_hits += map.contains(key);
+					}
+				}
+				hits += local_hits;
+			});
+		}
+		while (ready.load() != threads) {
+			std::this_thread::yield();
+		}
+		auto start = std::chrono::steady_clock::now();
+		go.store(true, std::memory_order_release);
+		for (auto& w : workers) {
+			w.join();
+		}
+		auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double>(end - start).count();
+	}
+}
+
+int main(int argc, char** argv) {
+	size_t total_ops = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : (1u << 22);
+	size_t keys = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : (1u << 16);
+	const size_t thread_counts[] = { 1, 2, 4, 8, 16, 32, 64 };
+	const unsigned write_permilles[] = { 0, 10, 100, 500 };
+
+	std::printf("[\n");
+	bool first = true;
+	for (unsigned write_permille : write_permilles) {
+		for (size_t threads : thread_counts) {
+			GlobalLockMap global;
+			ShardedMap sharded;
+			std::vector<std::pair<asset_id, entity>> preload;
+			for (asset_id k = 0; k < keys; k += 2) {
+				preload.emplace_back(k, entity(static_cast<types::u32>(k), 0u));
+				global.insert_or_assign(k, entity(static_cast<types::u32>(k), 0u));
+			}
+			sharded.insert_bulk(preload);
+
+			double global_time = run(global, threads, total_ops, keys, write_permille);
+			double sharded_time = run(sharded, threads, total_ops, keys, write_permille);
+			for (auto [name, time] : { std::pair{ "global_lock", global_time }, std::pair{ "sharded", sharded_time } }) {
+				std::printf("%s  {\"map\": \"%s\", \"threads\": %zu, \"write_ratio\": %.3f, \"ops\": %zu, \"seconds\": %.6f, \"mops_per_sec\": %.3f}",
+							first ? "" : ",\n", name, threads, write_permille / 1000.0, total_ops, time, total_ops / time / 1e6);
+				first = false;
+			}
+		}
+	}
+	std::printf("\n]\n");
+	return 0;
+}
@@ -0,0 +1,182 @@
+#pragma once
+#ifndef MYECS_BITMAP_H
+#define MYECS_BITMAP_H
+
+#include<algorithm>
+#include<bit>
+#include<vector>
+#include"types.h"
+#include"utils.h"
+
+#if defined(__AVX2__)
+#include<immintrin.h>
+#endif
+
+
+namespace myecs {
+
+	//one bit per id, grows on set()
+	class Bitmap {
+	public:
+		using word_type = types::u64;
+		static constexpr size_t word_bits = 64;
+
+	private:
+		std::vector<word_type> words;
+
+	public:
+		Bitmap() = default;
+		Bitmap(const Bitmap&) = default;
+		Bitmap(Bitmap&& other)noexcept :words(std::move(other.words)) {}
+
+		void set(size_t i) {
+			size_t w = i / word_bits;
+			if (w >= words.size()) {
+				MYECS_CHECK_ALLOCATION(w >= words.capacity());
+				words.resize(w + 1, 0);
+			}
+			words[w] |= word_type(1) << (i % word_bits);
+		}
+
+		void reset(size_t i) {
+			size_t w = i / word_bits;
+			if (w < words.size()) {
+				words[w] &= ~(word_type(1) << (i % word_bits));
+			}
+		}
+
+		MYECS_NODISCARD bool test(size_t i)const {
+			size_t w = i / word_bits;
+			return w < words.size() && (words[w] >> (i % word_bits)) & 1;
+		}
+
+		void clear() {
+			words.clear();
+		}
+
+		//drops the trailing empty words and gives back the capacity above them
+		void shrink() {
+			while (!words.empty() && words.back() == 0) {
+				words.pop_back();
+			}
+			words.shrink_to_fit();
+		}
+
+		//room for ids below count without allocation
+		void reserve(size_t count) {
+			size_t new_words = (count + word_bits - 1) / word_bits;
+			MYECS_CHECK_ALLOCATION(new_words > words.capacity());
+			words.reserve(new_words);
+		}
+
+		MYECS_NODISCARD size_t word_count()const {
+			return words.size();
+		}
+
+		MYECS_NODISCARD const word_type* data()const {
+			return words.data();
+		}
+
+		//word w, or 0 past the end
+		MYECS_NODISCARD word_type word(size_t w)const {
+			return w < words.size() ? words[w] : 0;
+		}
+
+		MYECS_NODISCARD size_t memory_usage()const {
+			return words.capacity() * sizeof(word_type);
+		}
+	};
+
+	namespace internal {
+		template<class Func>
+		inline void for_each_bit(Bitmap::word_type word, size_t base, Func& func) {
+			while (word) {
+				func(base + static_cast<size_t>(std::countr_zero(word)));
+				word &= word - 1;
+			}
+		}
+	}
+
+	//calls func(id) in increasing order for every id set in all maps and in none of excluded
+	//ANDs 256 bits per step, with AVX2 when the target has it
+	template<class Func>
+	void intersect(const Bitmap* const* maps, size_t count, const Bitmap* const* excluded, size_t excluded_count, Func&& func) {
+		using word_type = Bitmap::word_type;
+		constexpr size_t block = 4;
+		if (count == 0) {
+			return;
+		}
+		size_t words = maps[0]->word_count();
+		for (size_t m = 1; m < count; m++) {
+			words = std::min(words, maps[m]->word_count());
+		}
+
+		size_t w = 0;
+		for (; w + block <= words; w += block) {
+		#if defined(__AVX2__)
+			__m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(maps[0]->data() + w));
+			for (size_t m = 1; m < count; m++) {
+				acc = _mm256_and_si256(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(maps[m]->data() + w)));
+			}
+			for (size_t x = 0; x < excluded_count; x++) {
+				if (w + block <= excluded[x]->word_count()) {
+					acc = _mm256_andnot_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(excluded[x]->data() + w)), acc);
+				}
+			}
+			if (_mm256_testz_si256(acc, acc)) {
+				continue;
+			}
+			alignas(32) word_type out[block];
+			_mm256_store_si256(reinterpret_cast<__m256i*>(out), acc);
+			//the tail of a shorter excluded bitmap did not fit a full vector load
+			for (size_t x = 0; x < excluded_count; x++) {
+				if (w + block > excluded[x]->word_count()) {
+					for (size_t k = 0; k < block; k++) {
+						out[k] &= ~excluded[x]->word(w + k);
+					}
+				}
+			}
+		#else
+			word_type out[block];
+			for (size_t k = 0; k < block; k++) {
+				out[k] = maps[0]->data()[w + k];
+			}
+			for (size_t m = 1; m < count; m++) {
+				const word_type* data = maps[m]->data() + w;
+				for (size_t k = 0; k < block; k++) {
+					out[k] &= data[k];
+				}
+			}
+			for (size_t x = 0; x < excluded_count; x++) {
+				for (size_t k = 0; k < block; k++) {
+					out[k] &= ~excluded[x]->word(w + k);
+				}
+			}
+			if (!(out[0] | out[1] | out[2] | out[3])) {
+				continue;
+			}
+		#endif
+			for (size_t k = 0; k < block; k++) {
+				internal::for_each_bit(out[k], (w + k) * Bitmap::word_bits, func);
+			}
+		}
+		for (; w < words; w++) {
+			word_type acc = maps[0]->data()[w];
+			for (size_t m = 1; m < count && acc; m++) {
+				acc &= maps[m]->data()[w];
+			}
+			for (size_t x = 0; x < excluded_count && acc; x++) {
+				acc &= ~excluded[x]->word(w);
+			}
+			internal::for_each_bit(acc, w * Bitmap::word_bits, func);
+		}
+	}
+
+	template<class Func>
+	void intersect(const Bitmap* const* maps, size_t count, Func&& func) {
+		intersect(maps, count, nullptr, 0, std::forward<Func>(func));
+	}
+
+}//namespace myecs
+
+#endif
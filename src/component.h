@@ -1,14 +1,44 @@
 #pragma once
 #ifndef MYECS_COMPONENT_H
 #define MYECS_COMPONENT_H
+#include"bitmap.h"
 #include"container.h"
+#include"double_buffer.h"
+#include"index.h"
 #include"pool.h"
-#include<format>
+#include"soa.h"
 #include<functional>
 #include<optional>
+#include<span>
+#include<utility>
 
 
 namespace myecs {
+	//memory and occupancy of one component pool, all byte counts are allocated capacity
+	struct PoolStats {
+		std::string_view name;
+		size_t count = 0;			//live components
+		size_t capacity = 0;		//storage slots allocated
+		size_t free_count = 0;		//destroyed slots waiting for reuse
+		size_t dense_bytes = 0;		//entity list of the archetype
+		size_t sparse_bytes = 0;	//archetype sparse array and entity to component map
+		size_t storage_bytes = 0;	//component storage and its id generator
+		size_t bitmap_bytes = 0;	//occupancy bitmap
+		size_t tombstones = 0;		//entries of the entity list erased in place, see DeletionPolicy
+		size_t written = 0;			//slots the next swap_buffers() copies, double buffered components only
+		double sparse_fill = 0.0;	//live components per sparse slot
+
+		MYECS_NODISCARD size_t total_bytes()const {
+			return dense_bytes + sparse_bytes + storage_bytes + bitmap_bytes;
+		}
+
+		//free slots per storage slot ever used, 0 when the pool is packed
+		MYECS_NODISCARD double fragmentation()const {
+			size_t used = count + free_count;
+			return used ? static_cast<double>(free_count) / static_cast<double>(used) : 0.0;
+		}
+	};
+
 	class IComponentPool {
 	public:
 		using component = size_t;
@@ -17,16 +47,34 @@ namespace myecs {
 		//static constexpr component null_component = std::numeric_limits<component>::max();
 		SparseSet<entity> archetype;
 		IntVector<component> entity_to_component;
+		//owner of every storage slot, only meaningful for live slots
+		IntVector<entity> component_to_entity;
+		//bit per entity id, lets multi component views AND whole words instead of probing
+		Bitmap occupancy_bitmap;
+
+		//fits the entity and slot indexed arrays to the live components
+		void shrink_arrays() {
+			archetype.shrink();
+			entity_to_component.resize(std::min(entity_to_component.size(), archetype.max_value_size()));
+			entity_to_component.shrink();
+			component_to_entity.resize(std::min(component_to_entity.size(), max_count()));
+			component_to_entity.shrink();
+			occupancy_bitmap.shrink();
+		}
 
 	public:
 		IComponentPool() = default;
 		IComponentPool(IComponentPool&& other) noexcept :
 			archetype(std::move(other.archetype)),
-			entity_to_component(std::move(other.entity_to_component)) {
+			entity_to_component(std::move(other.entity_to_component)),
+			component_to_entity(std::move(other.component_to_entity)),
+			occupancy_bitmap(std::move(other.occupancy_bitmap)) {
 		}
 		virtual ~IComponentPool() = default;
 
 		virtual void destroy(entity e) = 0;
+		//destroys the components of a batch without duplicates, entities without one are skipped
+		virtual void destroy_bulk(const entity* entities, size_t count) = 0;
 
 		MYECS_NODISCARD bool has(entity e)const {
 			return archetype.has(e);
@@ -36,17 +84,129 @@ namespace myecs {
 			return archetype;
 		}
 
+		MYECS_NODISCARD const Bitmap& occupancy()const {
+			return occupancy_bitmap;
+		}
+
+		//the index loads of has() and get(), issue well before prefetch_component for the same entity
+		void prefetch_index(entity e)const {
+			size_t id = e.get_id();
+			archetype.prefetch_sparse(id);
+			if (id < entity_to_component.size()) {
+				MYECS_PREFETCH(&entity_to_component[id]);
+			}
+		}
+
+		//the entity indexed arrays sized for ids below count, so adding components to them does not allocate
+		void reserve_ids(size_t count) {
+			if (count == 0) {
+				return;
+			}
+			archetype.reserve(archetype.size(), count - 1);
+			entity_to_component.reserve(count);
+			occupancy_bitmap.reserve(count);
+		}
+
+		//in_place deletion keeps the entity list in order while components are removed, see DeletionPolicy
+		void set_deletion(DeletionPolicy policy) {
+			archetype.set_deletion(policy);
+		}
+
+		MYECS_NODISCARD DeletionPolicy deletion_policy()const {
+			return archetype.deletion_policy();
+		}
+
+		//drops the tombstones of the entity list
+		void purge() {
+			archetype.purge();
+		}
+
 		virtual void clear() = 0;
 
+		//moves components out of the tail of the storage into free slots and shrinks every array to fit.
+		//component addresses change, entities keep theirs
+		virtual void compact() = 0;
+
+		//every entity e becomes to[e.get_id()], see Registry::renumber
+		virtual void renumber(const IntVector<entity>& to) {
+			IntVector<component> slots;
+			for (entity e : archetype) {
+				entity now = to[e.get_id()];
+				component c = entity_to_component[e.get_id()];
+				slots.force_get(now.get_id()) = c;
+				component_to_entity[c] = now;
+			}
+			entity_to_component = std::move(slots);
+			archetype.remap([&](entity e) {
+				return to[e.get_id()];
+			});
+			occupancy_bitmap.clear();
+			for (entity e : archetype) {
+				occupancy_bitmap.set(e.get_id());
+			}
+			shrink_arrays();
+		}
+
 		MYECS_NODISCARD virtual size_t count()const = 0;
 		MYECS_NODISCARD virtual size_t max_count()const = 0;
+		MYECS_NODISCARD virtual PoolStats stats()const = 0;
 	};
 
 
+	namespace internal {
+		template<class T>
+		struct storage_for {
+			using type = pool::Pool<T>;
+		};
+
+		template<soa_component T>
+		struct storage_for<T> {
+			using type = pool::SoaPool<T>;
+		};
+
+		template<double_buffered_component T>
+			requires (!soa_component<T>)
+		struct storage_for<T> {
+			using type = pool::DoubleBufferedPool<T>;
+		};
+	}
+
+	//get() returns T&, or a SoaRef<T> for types that opted into soa storage (see soa_traits)
 	template<class T>
-	class ComponentPool :public IComponentPool {
+	class ComponentPool final :public IComponentPool {
+		static_assert(!(soa_component<T> && double_buffered_component<T>), "soa storage can not be double buffered");
+
 	private:
-		pool::Pool<T> pool;
+		using storage_type = typename internal::storage_for<T>::type;
+
+		storage_type pool;
+		//secondary indices with the type hash of the index class
+		std::vector<std::pair<size_t, std::unique_ptr<IComponentIndex<T>>>> indices;
+
+		void index_insert(entity e) {
+			if (!indices.empty()) {
+				const T& value = read(e);
+				for (auto& [hash, index] : indices) {
+					index->insert(e, value);
+				}
+			}
+		}
+
+		//by the keys the indices filed e under, the current value may differ
+		void index_erase(entity e) {
+			for (auto& [hash, index] : indices) {
+				index->erase(e);
+			}
+		}
+
+		void destroy_one(entity e) {
+			if (!has(e))return;
+			index_erase(e);
+			archetype.erase(e);
+			occupancy_bitmap.reset(e.get_id());
+			auto c = entity_to_component[e.get_id()];
+			pool.destroy(c);
+		}
 
 	public:
 		ComponentPool() {}
@@ -54,37 +214,374 @@ namespace myecs {
 
 		ComponentPool(ComponentPool&& other)noexcept :
 			IComponentPool(std::move(other)),
-			pool(std::move(other.pool)) {
+			pool(std::move(other.pool)),
+			indices(std::move(other.indices)) {
 		}
 
 		template<class ...Args>
-		T& create(entity e, Args&&... args) {
+		decltype(auto) create(entity e, Args&&... args) {
 			if (has(e)) {
 				throw std::runtime_error("entity already has component");
 			}
 			component id = pool.create(std::forward<Args>(args)...);
 			archetype.insert(e);
+			occupancy_bitmap.set(e.get_id());
 			entity_to_component.force_get(e.get_id()) = id;
+			component_to_entity.force_get(id) = e;
+			index_insert(e);
 			return pool.get(id);
 		}
 
-		MYECS_NODISCARD T& get(entity e) {
+		//one copy of value for each of entities, none of which may own T yet. an entity listed twice
+		//gets one component, the slot taken for the repeat goes back to the storage
+		void create_bulk(const entity* entities, size_t count, const T& value) {
+			for (size_t i = 0; i < count; i++) {
+				if (has(entities[i])) {
+					throw std::runtime_error("entity already has component");
+				}
+			}
+			std::vector<size_t> slots(count);
+			pool.create_bulk(count, value, slots.data());
+			size_t max_id = 0;
+			size_t max_slot = 0;
+			for (size_t i = 0; i < count; i++) {
+				max_id = std::max<size_t>(max_id, entities[i].get_id());
+				max_slot = std::max(max_slot, slots[i]);
+			}
+			archetype.reserve(archetype.size() + count, max_id);
+			entity_to_component.reserve(max_id + 1);
+			component_to_entity.reserve(max_slot + 1);
+			for (size_t i = 0; i < count; i++) {
+				entity e = entities[i];
+				if (archetype.has(e)) {
+					pool.destroy(slots[i]);
+					continue;
+				}
+				archetype.insert(e);
+				occupancy_bitmap.set(e.get_id());
+				entity_to_component.force_get(e.get_id()) = slots[i];
+				component_to_entity.force_get(slots[i]) = e;
+				index_insert(e);
+			}
+		}
+
+		//calls func(get(e)) and updates the secondary indices from the old to the new value
+		template<class Func>
+		decltype(auto) patch(entity e, Func&& func) {
+			index_erase(e);
+			func(get(e));
+			index_insert(e);
+			return get(e);
+		}
+
+		//the index of this type, built from the current components on first use
+		template<class Index>
+			requires std::derived_from<Index, IComponentIndex<T>>
+		Index& index() {
+			if (Index* ret = find_index<Index>()) {
+				return *ret;
+			}
+			auto index = std::make_unique<Index>();
+			for (auto e : archetype) {
+				const T& value = read(e);
+				index->insert(e, value);
+			}
+			Index& ret = *index;
+			indices.emplace_back(types::type_hash<Index>(), std::move(index));
+			return ret;
+		}
+
+		template<class Index>
+		MYECS_NODISCARD Index* find_index() {
+			for (auto& [hash, index] : indices) {
+				if (hash == types::type_hash<Index>()) {
+					return static_cast<Index*>(index.get());
+				}
+			}
+			return nullptr;
+		}
+
+		template<class Index>
+		void drop_index() {
+			std::erase_if(indices, [](const auto& entry) {
+				return entry.first == types::type_hash<Index>();
+			});
+		}
+
+		MYECS_NODISCARD decltype(auto) get(entity e) {
 			MYECS_ASSERT(has(e), "invalid entity");
 			component c = entity_to_component[e.get_id()];
 			return pool.get(c);
 		}
 
+		//get() without counting as a write: const T& for double buffered storage, which leaves the slot
+		//unmarked for the next swap, the same as get() for the other storages
+		MYECS_NODISCARD decltype(auto) read(entity e) {
+			if constexpr (double_buffered_component<T>) {
+				MYECS_ASSERT(has(e), "invalid entity");
+				return std::as_const(pool).get(entity_to_component[e.get_id()]);
+			}
+			else {
+				return get(e);
+			}
+		}
+
+		//the value e had when the last frame ended, see double_buffer_traits
+		MYECS_NODISCARD const T& previous(entity e)const requires double_buffered_component<T> {
+			MYECS_ASSERT(has(e), "invalid entity");
+			return pool.previous(entity_to_component[e.get_id()]);
+		}
+
+		void swap_buffers() requires double_buffered_component<T> {
+			pool.swap();
+		}
+
+		//the dense entry checked by has() and the storage slot, reads the index arrays
+		void prefetch_component(entity e)const {
+			size_t id = e.get_id();
+			archetype.prefetch_dense(id);
+			if (id < entity_to_component.size()) {
+				pool.prefetch(entity_to_component[id]);
+			}
+		}
+
+		//storage slot of a component, e must have one
+		MYECS_NODISCARD size_t slot_of(entity e)const {
+			return entity_to_component[e.get_id()];
+		}
+
+		//entity whose component lives in this slot, null_entity for free slots
+		MYECS_NODISCARD entity owner(size_t slot)const {
+			if (!pool.valid(slot)) {
+				return null_entity;
+			}
+			return component_to_entity[slot];
+		}
+
+		//slot 0 of the storage, null before the first create(), not available for soa storage
+		MYECS_NODISCARD T* data() {
+			return pool.data();
+		}
+
+		//calls func(std::span<const entity>, std::span<T>) for every run of consecutive live slots,
+		//or func(std::span<const entity>, std::span<Field>...) with one span per field for soa storage
+		//the spans stay valid until the next create() on this pool
+		template<class Func>
+		void each_span(Func&& func) {
+			const entity* owners = component_to_entity.begin();
+			size_t slots = pool.max_count();
+			size_t i = 0;
+			while (i < slots) {
+				while (i < slots && !pool.valid(i)) {
+					i++;
+				}
+				size_t begin = i;
+				while (i < slots && pool.valid(i)) {
+					i++;
+				}
+				if (begin < i) {
+					std::apply([&](auto... spans) {
+						func(std::span<const entity>(owners + begin, i - begin), spans...);
+					}, pool.spans(begin, i - begin));
+				}
+			}
+		}
+
 		void clear()override {
+			for (auto& [hash, index] : indices) {
+				index->clear();
+			}
 			pool.clear();
 			archetype.clear();
 			entity_to_component.clear();
+			component_to_entity.clear();
+			occupancy_bitmap.clear();
+		}
+
+		//storage and dense arrays for count components without allocation
+		void reserve(size_t count) {
+			pool.reserve(count);
+			archetype.reserve(count, 0);
+			component_to_entity.reserve(count);
+		}
+
+		void set_growth(GrowthPolicy policy) {
+			pool.set_growth(policy);
+		}
+
+		void compact()override {
+			pool.compact([&](size_t from, size_t to) {
+				entity e = component_to_entity[from];
+				component_to_entity[to] = e;
+				entity_to_component[e.get_id()] = to;
+			});
+			shrink_arrays();
+		}
+
+		//the secondary indices are rebuilt under the new handles
+		void renumber(const IntVector<entity>& to)override {
+			IComponentPool::renumber(to);
+			if (!indices.empty()) {
+				for (auto& [hash, index] : indices) {
+					index->clear();
+				}
+				for (auto e : archetype) {
+					index_insert(e);
+				}
+			}
 		}
 
 		void destroy(entity e)override {
+			destroy_one(e);
+		}
+
+		//one pass without virtual calls, a batch holding every component falls back to clear()
+		void destroy_bulk(const entity* entities, size_t count)override {
+			size_t owned = 0;
+			for (size_t i = 0; i < count; i++) {
+				owned += has(entities[i]);
+			}
+			if (owned == 0) {
+				return;
+			}
+			//an in_place set may be iterated right now, clear() would leave that walking dead entries
+			if (owned == archetype.size() && archetype.deletion_policy().kind == DeletionPolicy::Kind::swap_and_pop) {
+				clear();
+				return;
+			}
+			for (size_t i = 0; i < count; i++) {
+				destroy_one(entities[i]);
+			}
+		}
+
+		MYECS_NODISCARD size_t count()const override {
+			return pool.count();
+		}
+		MYECS_NODISCARD size_t max_count()const override {
+			return pool.max_count();
+		}
+
+		MYECS_NODISCARD PoolStats stats()const override {
+			PoolStats ret;
+			ret.name = types::type_name<T>();
+			ret.count = pool.count();
+			ret.capacity = pool.capacity();
+			ret.free_count = pool.free_count();
+			ret.dense_bytes = archetype.dense_memory();
+			ret.sparse_bytes = archetype.sparse_memory() + entity_to_component.memory_usage() + component_to_entity.memory_usage();
+			ret.storage_bytes = pool.memory_usage();
+			ret.bitmap_bytes = occupancy_bitmap.memory_usage();
+			ret.tombstones = archetype.tombstone_count();
+			if constexpr (double_buffered_component<T>) {
+				ret.written = pool.written_count();
+			}
+			size_t slots = archetype.max_value_size();
+			ret.sparse_fill = slots ? static_cast<double>(archetype.size()) / static_cast<double>(slots) : 0.0;
+			return ret;
+		}
+	};
+
+	//pool of a component type registered at runtime, see Registry::add_component.
+	//same bookkeeping as ComponentPool, the components are raw bytes handed out as void*
+	class RuntimeComponentPool final :public IComponentPool {
+	private:
+		pool::RawPool pool;
+
+		void destroy_one(entity e) {
 			if (!has(e))return;
 			archetype.erase(e);
-			auto c = entity_to_component[e.get_id()];
-			pool.destroy(c);
+			occupancy_bitmap.reset(e.get_id());
+			pool.destroy(entity_to_component[e.get_id()]);
+		}
+
+	public:
+		explicit RuntimeComponentPool(std::shared_ptr<const pool::TypeInfo> info) :pool(std::move(info)) {}
+		RuntimeComponentPool(RuntimeComponentPool&& other)noexcept :
+			IComponentPool(std::move(other)),
+			pool(std::move(other.pool)) {
+		}
+
+		MYECS_NODISCARD const pool::TypeInfo& type()const {
+			return pool.type();
+		}
+
+		//moves value into the new component, or constructs it through the type info for null
+		void* create(entity e, void* value = nullptr) {
+			if (has(e)) {
+				throw std::runtime_error("entity already has component");
+			}
+			component id = pool.create(value);
+			archetype.insert(e);
+			occupancy_bitmap.set(e.get_id());
+			entity_to_component.force_get(e.get_id()) = id;
+			component_to_entity.force_get(id) = e;
+			return pool.get(id);
+		}
+
+		MYECS_NODISCARD void* get(entity e) {
+			MYECS_ASSERT(has(e), "invalid entity");
+			return pool.get(entity_to_component[e.get_id()]);
+		}
+
+		void prefetch_component(entity e)const {
+			size_t id = e.get_id();
+			archetype.prefetch_dense(id);
+			if (id < entity_to_component.size()) {
+				pool.prefetch(entity_to_component[id]);
+			}
+		}
+
+		MYECS_NODISCARD size_t slot_of(entity e)const {
+			return entity_to_component[e.get_id()];
+		}
+
+		MYECS_NODISCARD entity owner(size_t slot)const {
+			if (!pool.valid(slot)) {
+				return null_entity;
+			}
+			return component_to_entity[slot];
+		}
+
+		//slot 0 of the storage, slots are type().stride() bytes apart
+		MYECS_NODISCARD std::byte* data() {
+			return pool.data();
+		}
+
+		void clear()override {
+			pool.clear();
+			archetype.clear();
+			entity_to_component.clear();
+			component_to_entity.clear();
+			occupancy_bitmap.clear();
+		}
+
+		void reserve(size_t count) {
+			pool.reserve(count);
+			archetype.reserve(count, 0);
+			component_to_entity.reserve(count);
+		}
+
+		void set_growth(GrowthPolicy policy) {
+			pool.set_growth(policy);
+		}
+
+		void compact()override {
+			pool.compact([&](size_t from, size_t to) {
+				entity e = component_to_entity[from];
+				component_to_entity[to] = e;
+				entity_to_component[e.get_id()] = to;
+			});
+			shrink_arrays();
+		}
+
+		void destroy(entity e)override {
+			destroy_one(e);
+		}
+
+		void destroy_bulk(const entity* entities, size_t count)override {
+			for (size_t i = 0; i < count; i++) {
+				destroy_one(entities[i]);
+			}
 		}
 
 		MYECS_NODISCARD size_t count()const override {
@@ -93,6 +590,22 @@ namespace myecs {
 		MYECS_NODISCARD size_t max_count()const override {
 			return pool.max_count();
 		}
+
+		MYECS_NODISCARD PoolStats stats()const override {
+			PoolStats ret;
+			ret.name = pool.type().name;
+			ret.count = pool.count();
+			ret.capacity = pool.capacity();
+			ret.free_count = pool.free_count();
+			ret.dense_bytes = archetype.dense_memory();
+			ret.sparse_bytes = archetype.sparse_memory() + entity_to_component.memory_usage() + component_to_entity.memory_usage();
+			ret.storage_bytes = pool.memory_usage();
+			ret.bitmap_bytes = occupancy_bitmap.memory_usage();
+			ret.tombstones = archetype.tombstone_count();
+			size_t slots = archetype.max_value_size();
+			ret.sparse_fill = slots ? static_cast<double>(archetype.size()) / static_cast<double>(slots) : 0.0;
+			return ret;
+		}
 	};
 
 }//namespace myecs
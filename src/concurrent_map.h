@@ -0,0 +1,186 @@
+#pragma once
+#ifndef MYECS_CONCURRENT_MAP_H
+#define MYECS_CONCURRENT_MAP_H
+
+#include"dense_map.h"
+#include<array>
+#include<iterator>
+#include<mutex>
+#include<optional>
+#include<shared_mutex>
+#include<vector>
+
+
+namespace myecs {
+
+	//a DenseMap split into 2^ShardBits shards, each guarded by its own reader/writer lock
+	//readers of different shards never touch the same cache line, writers only block their own shard
+	//references never escape a lock: lookups return copies or run a visitor under the shared lock
+	template<class Key, class Type, size_t ShardBits = 5, class Hash = std::hash<Key>, class KeyEq = std::equal_to<>>
+	class ConcurrentDenseMap {
+	public:
+		using map_type = DenseMap<Key, Type, Hash, KeyEq>;
+		static constexpr size_t shard_count = size_t(1) << ShardBits;
+
+	private:
+		static_assert(ShardBits > 0 && ShardBits < 16, "shard bits out of range");
+
+		struct alignas(64) Shard {
+			mutable std::shared_mutex mutex;
+			map_type map;
+		};
+
+		std::array<Shard, shard_count> shards;
+		Hash myHash;
+
+		//DenseMap buckets by the low hash bits, so pick shards with the high bits of a mixed hash.
+		//std::hash of integers is the identity on most standard libraries, hence the mixing step
+		template<class _Key>
+		size_t shard_index(const _Key& key)const {
+			uint64_t h = static_cast<uint64_t>(myHash(key));
+			h ^= h >> 33;
+			h *= 0xFF51AFD7ED558CCDull;
+			h ^= h >> 33;
+			return static_cast<size_t>(h >> (64 - ShardBits));
+		}
+
+		template<class _Key>
+		Shard& shard_of(const _Key& key) {
+			return shards[shard_index(key)];
+		}
+
+		template<class _Key>
+		const Shard& shard_of(const _Key& key)const {
+			return shards[shard_index(key)];
+		}
+
+		ConcurrentDenseMap(const ConcurrentDenseMap&) = delete;
+		ConcurrentDenseMap& operator=(const ConcurrentDenseMap&) = delete;
+
+	public:
+		ConcurrentDenseMap() = default;
+		~ConcurrentDenseMap() = default;
+
+		template<class _Key = Key>
+		MYECS_NODISCARD bool contains(const _Key& key)const {
+			const Shard& shard = shard_of(key);
+			std::shared_lock lock(shard.mutex);
+			return shard.map.contains(key);
+		}
+
+		template<class _Key = Key>
+		MYECS_NODISCARD std::optional<Type> find(const _Key& key)const {
+			const Shard& shard = shard_of(key);
+			std::shared_lock lock(shard.mutex);
+			if (auto it = shard.map.find(key); it != shard.map.end()) {
+				return it->second;
+			}
+			return std::nullopt;
+		}
+
+		//calls func(const Type&) under the shared lock, returns false when the key is missing
+		template<class _Key = Key, class Func>
+		bool visit(const _Key& key, Func&& func)const {
+			const Shard& shard = shard_of(key);
+			std::shared_lock lock(shard.mutex);
+			if (auto it = shard.map.find(key); it != shard.map.end()) {
+				std::forward<Func>(func)(it->second);
+				return true;
+			}
+			return false;
+		}
+
+		//returns false when the key already exists, the old value is kept
+		template<class _Key = Key, class ...Args>
+		bool insert(_Key&& key, Args&&... args) {
+			Shard& shard = shard_of(key);
+			std::unique_lock lock(shard.mutex);
+			size_t old_size = shard.map.size();
+			shard.map.emplace_or_get(std::forward<_Key>(key), std::forward<Args>(args)...);
+			return shard.map.size() != old_size;
+		}
+
+		template<class _Key = Key, class _Type = Type>
+		void insert_or_assign(_Key&& key, _Type&& value) {
+			Shard& shard = shard_of(key);
+			std::unique_lock lock(shard.mutex);
+			shard.map[std::forward<_Key>(key)] = std::forward<_Type>(value);
+		}
+
+		//inserts a range of pairs taking every shard lock at most once
+		//existing keys are kept, returns the number of inserted pairs.
+		//the pairs are bucketed by shard in one pass, so the range is walked once however many shards there are
+		template<std::forward_iterator It>
+		size_t insert_bulk(It first, It last) {
+			std::array<std::vector<It>, shard_count> groups;
+			for (It it = first; it != last; ++it) {
+				groups[shard_index(it->first)].push_back(it);
+			}
+			size_t inserted = 0;
+			for (size_t s = 0; s < shard_count; s++) {
+				if (groups[s].empty()) {
+					continue;
+				}
+				Shard& shard = shards[s];
+				std::unique_lock lock(shard.mutex);
+				size_t old_size = shard.map.size();
+				for (It it : groups[s]) {
+					shard.map.emplace_or_get(it->first, it->second);
+				}
+				inserted += shard.map.size() - old_size;
+			}
+			return inserted;
+		}
+
+		template<class Range>
+		size_t insert_bulk(const Range& range) {
+			return insert_bulk(std::begin(range), std::end(range));
+		}
+
+		template<class _Key = Key>
+		bool erase(const _Key& key) {
+			Shard& shard = shard_of(key);
+			std::unique_lock lock(shard.mutex);
+			if (!shard.map.contains(key)) {
+				return false;
+			}
+			shard.map.erase(key);
+			return true;
+		}
+
+		//not a snapshot: shards are counted one after another
+		MYECS_NODISCARD size_t size()const {
+			size_t ret = 0;
+			for (const Shard& shard : shards) {
+				std::shared_lock lock(shard.mutex);
+				ret += shard.map.size();
+			}
+			return ret;
+		}
+
+		MYECS_NODISCARD bool empty()const {
+			return size() == 0;
+		}
+
+		void clear() {
+			for (Shard& shard : shards) {
+				std::unique_lock lock(shard.mutex);
+				shard.map.clear();
+			}
+		}
+
+		//calls func(const Key&, const Type&) for every pair, one shard locked at a time
+		template<class Func>
+		void for_each(Func&& func)const {
+			for (const Shard& shard : shards) {
+				std::shared_lock lock(shard.mutex);
+				for (const auto& pair : shard.map) {
+					func(pair.first, pair.second);
+				}
+			}
+		}
+	};
+
+}//namespace myecs
+
+#endif
@@ -2,7 +2,9 @@
 #ifndef CONTAINER_H
 #define CONTAINER_H
 #include<vector>
+#include<iterator>
 #include<limits>
+#include<stdexcept>
 #include<assert.h>
 #include"types.h"
 #include"utils.h"
@@ -40,8 +42,9 @@ namespace myecs {
 			return Super::operator[](static_cast<size_t>(index));
 		}
 
-		T& operator[](entity e) {
-			return this->operator[](e.id);
+		template<class Traits>
+		T& operator[](basic_entity<Traits> e) {
+			return this->operator[](e.get_id());
 		}
 
 		template<class U>
@@ -50,8 +53,9 @@ namespace myecs {
 			return Super::operator[](static_cast<size_t>(index));
 		}
 
-		const T& operator[](entity e)const {
-			return this->operator[](e.id);
+		template<class Traits>
+		const T& operator[](basic_entity<Traits> e)const {
+			return this->operator[](e.get_id());
 		}
 	};
 
@@ -73,11 +77,20 @@ namespace myecs {
 		}
 		~IntVector() = default;
 
+		IntVector& operator=(const IntVector&) = default;
+		IntVector& operator=(IntVector&& other)noexcept {
+			data = std::move(other.data);
+			m_size = other.m_size;
+			other.m_size = 0;
+			return *this;
+		}
+
 		void emplace_back(T t) {
 			if (data.size() > m_size) {
 				data[m_size] = t;
 			}
 			else {
+				MYECS_CHECK_ALLOCATION(data.size() == data.capacity());
 				data.emplace_back(t);
 			}
 			++m_size;
@@ -102,8 +115,10 @@ namespace myecs {
 			data.clear();
 		}
 
+		//gives back the capacity above size()
 		void shrink() {
 			data.resize(m_size);
+			data.shrink_to_fit();
 		}
 
 		T& operator[](size_t i) {
@@ -117,6 +132,7 @@ namespace myecs {
 		T& force_get(size_t i) {
 			m_size = std::max(i + 1, m_size);
 			if (m_size > data.size()) {
+				MYECS_CHECK_ALLOCATION(m_size > data.capacity());
 				data.resize(m_size, static_cast<T>(0));
 			}
 			return data[i];
@@ -126,6 +142,15 @@ namespace myecs {
 			return m_size;
 		}
 
+		size_t capacity()const {
+			return data.capacity();
+		}
+
+		//bytes held by the buffer, including slots above size()
+		size_t memory_usage()const {
+			return data.capacity() * sizeof(T);
+		}
+
 		const_iterator begin()const {
 			return (const_iterator)(data.data());
 		}
@@ -150,15 +175,22 @@ namespace myecs {
 			return data[m_size - 1];
 		}
 
+		void reserve(size_t new_capacity) {
+			MYECS_CHECK_ALLOCATION(new_capacity > data.capacity());
+			data.reserve(new_capacity);
+		}
+
 		void resize(size_t new_size) {
 			m_size = new_size;
 			if (data.size() < m_size) {
+				MYECS_CHECK_ALLOCATION(m_size > data.capacity());
 				data.resize(m_size);
 			}
 		}
 
 		void resize(size_t new_size, T val) {
 			if (data.size() < new_size) {
+				MYECS_CHECK_ALLOCATION(new_size > data.capacity());
 				data.resize(new_size, val);
 			}
 			for (size_t i = m_size; i < new_size; i++) {
@@ -190,6 +222,10 @@ namespace myecs {
 			m_vector.push_back(t);
 		}
 
+		void reserve(size_t new_capacity) {
+			m_vector.reserve(new_capacity);
+		}
+
 		T& top() {
 			return m_vector.back();
 		}
@@ -209,6 +245,14 @@ namespace myecs {
 		bool empty()const {
 			return m_vector.empty();
 		}
+
+		size_t memory_usage()const {
+			return m_vector.memory_usage();
+		}
+
+		void shrink() {
+			m_vector.shrink();
+		}
 	};
 
 
@@ -244,6 +288,14 @@ namespace myecs {
 			sparse[static_cast<size_t>(num)] = static_cast<T>(dense.size() - 1ull);
 		}
 
+		//room for count values up to max_value without further allocation
+		void reserve(size_t count, T max_value) {
+			dense.reserve(count);
+			if (sparse.size() <= max_value) {
+				sparse.resize(max_value + 1ull, null_value);
+			}
+		}
+
 		void erase(T num) {
 			if (num >= sparse.size()) {
 				return;
@@ -267,6 +319,17 @@ namespace myecs {
 			sparse.clear();
 		}
 
+		//gives back the capacity above size(), the sparse array ends after the largest value
+		void shrink() {
+			size_t used = 0;
+			for (T num : dense) {
+				used = std::max(used, static_cast<size_t>(num) + 1);
+			}
+			sparse.resize(std::min(sparse.size(), used));
+			sparse.shrink();
+			dense.shrink();
+		}
+
 		bool has(T num)const {
 			if (static_cast<size_t>(num) >= sparse.size()) {
 				return false;
@@ -282,6 +345,18 @@ namespace myecs {
 			return sparse.size();
 		}
 
+		size_t dense_memory()const {
+			return dense.memory_usage();
+		}
+
+		size_t sparse_memory()const {
+			return sparse.memory_usage();
+		}
+
+		size_t memory_usage()const {
+			return dense_memory() + sparse_memory();
+		}
+
 		const_iterator begin() const { return dense.begin(); }
 		const_iterator end() const { return dense.end(); }
 
@@ -290,25 +365,118 @@ namespace myecs {
 		}
 	};
 
-	template<>
-	class SparseSet<entity> {
+	//how SparseSet<entity> removes entries
+	struct DeletionPolicy {
+		enum class Kind {
+			swap_and_pop,	//the last entry fills the hole, so the set must not be iterated meanwhile
+			in_place		//the entry becomes a tombstone that iteration skips, entries never move
+		};
+
+		Kind kind = Kind::swap_and_pop;
+		//in_place: share of tombstones among the dense entries above which insert() purges them first
+		float compact_ratio = 0.5f;
+
+		MYECS_NODISCARD static constexpr DeletionPolicy swap_and_pop() {
+			return {};
+		}
+
+		MYECS_NODISCARD static constexpr DeletionPolicy in_place(float compact_ratio = 0.5f) {
+			return { Kind::in_place, compact_ratio };
+		}
+	};
+
+	template<class Traits>
+	class SparseSet<basic_entity<Traits>> {
 	private:
+		using entity = basic_entity<Traits>;
 		using dense_t = IntVector<entity>;
 		using sparse_t = IntVector<size_t>;
 
 		dense_t dense;
 		sparse_t sparse;
+		size_t tombstones = 0;
+		DeletionPolicy deletion;
 
 		static constexpr size_t null_value = std::numeric_limits<size_t>::max();
 
 	public:
 		static constexpr size_t _max_size = 0x100000;
-		using const_iterator = dense_t::const_iterator;
+		//dense entry of an entity erased in place
+		static constexpr entity tombstone = basic_null_entity<Traits>;
+
+		//a pointer walk over the dense entries that steps over tombstones
+		class const_iterator {
+		private:
+			const entity* it = nullptr;
+			const entity* last = nullptr;
+
+			void skip() {
+				while (it != last && *it == tombstone) {
+					++it;
+				}
+			}
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = entity;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const entity*;
+			using reference = const entity&;
+
+			const_iterator() = default;
+			const_iterator(const entity* it, const entity* last) :it(it), last(last) {
+				skip();
+			}
+
+			reference operator*()const {
+				return *it;
+			}
+
+			pointer operator->()const {
+				return it;
+			}
+
+			const_iterator& operator++() {
+				++it;
+				skip();
+				return *this;
+			}
+
+			const_iterator operator++(int) {
+				const_iterator ret = *this;
+				++*this;
+				return ret;
+			}
+
+			bool operator==(const const_iterator& other)const {
+				return it == other.it;
+			}
+		};
 
 		SparseSet() {}
+		SparseSet(const SparseSet&) = default;
+		SparseSet(SparseSet&& other)noexcept :
+			dense(std::move(other.dense)),
+			sparse(std::move(other.sparse)),
+			tombstones(other.tombstones),
+			deletion(other.deletion) {
+			other.tombstones = 0;
+		}
+
+		SparseSet& operator=(const SparseSet&) = default;
+		SparseSet& operator=(SparseSet&& other)noexcept {
+			dense = std::move(other.dense);
+			sparse = std::move(other.sparse);
+			tombstones = other.tombstones;
+			deletion = other.deletion;
+			other.tombstones = 0;
+			return *this;
+		}
 
+		//appends e. in_place sets purge their tombstones first once they pass the compact ratio,
+		//so like any insert this must not happen while the set is iterated
 		void insert(entity e) {
-			size_t id = static_cast<size_t>(e.id);
+			size_t id = e.get_id();
 			MYECS_ASSERT(id < _max_size, "number too big!");
 			if (sparse.size() <= id) {
 				sparse.resize(id + 1ull, null_value);
@@ -316,12 +484,23 @@ namespace myecs {
 			else if (sparse[id] != null_value) {
 				return;
 			}
+			if (tombstones && static_cast<float>(tombstones) > deletion.compact_ratio * static_cast<float>(dense.size())) {
+				purge();
+			}
 			dense.emplace_back(e);
 			sparse[id] = dense.size() - 1ull;
 		}
 
+		//room for count entities with ids up to max_id without further allocation
+		void reserve(size_t count, size_t max_id) {
+			dense.reserve(count + tombstones);
+			if (sparse.size() <= max_id) {
+				sparse.resize(max_id + 1ull, null_value);
+			}
+		}
+
 		void erase(entity e) {
-			size_t id = static_cast<size_t>(e.id);
+			size_t id = e.get_id();
 			if (id >= sparse.size()) {
 				return;
 			}
@@ -330,38 +509,147 @@ namespace myecs {
 				return;
 			}
 
+			if (deletion.kind == DeletionPolicy::Kind::in_place) {
+				dense[index] = tombstone;
+				sparse[id] = null_value;
+				tombstones++;
+				return;
+			}
+
 			entity last = dense.back();
 			dense[index] = last;
-			sparse[static_cast<size_t>(last.id)] = index;
+			sparse[last.get_id()] = index;
 			dense.pop_back();
 
 			//in case when the dense vector is empty
 			sparse[id] = null_value;
 		}
 
+		//switching to swap_and_pop purges the tombstones
+		void set_deletion(DeletionPolicy policy) {
+			deletion = policy;
+			if (deletion.kind == DeletionPolicy::Kind::swap_and_pop) {
+				purge();
+			}
+		}
+
+		MYECS_NODISCARD DeletionPolicy deletion_policy()const {
+			return deletion;
+		}
+
+		//drops the tombstones, the live entries keep their order
+		void purge() {
+			if (!tombstones) {
+				return;
+			}
+			size_t next = 0;
+			for (size_t i = 0; i < dense.size(); i++) {
+				entity e = dense[i];
+				if (e == tombstone) {
+					continue;
+				}
+				dense[next] = e;
+				sparse[e.get_id()] = next;
+				next++;
+			}
+			dense.resize(next);
+			tombstones = 0;
+		}
+
 		void clear() {
 			dense.clear();
 			sparse.clear();
+			tombstones = 0;
+		}
+
+		//gives back the capacity above size(), the sparse array ends after the largest id
+		void shrink() {
+			purge();
+			size_t used = 0;
+			for (entity e : dense) {
+				used = std::max(used, e.get_id() + 1);
+			}
+			sparse.resize(std::min(sparse.size(), used));
+			sparse.shrink();
+			dense.shrink();
+		}
+
+		//replaces every entity with func(entity) in place, the order is kept and the new ids must be distinct
+		template<class Func>
+		void remap(Func&& func) {
+			purge();
+			for (entity e : dense) {
+				sparse[e.get_id()] = null_value;
+			}
+			for (size_t i = 0; i < dense.size(); i++) {
+				dense[i] = func(dense[i]);
+				size_t id = dense[i].get_id();
+				if (sparse.size() <= id) {
+					sparse.resize(id + 1ull, null_value);
+				}
+				sparse[id] = i;
+			}
 		}
 
 		bool has(entity e)const {
-			size_t id = static_cast<size_t>(e.id);
+			size_t id = e.get_id();
 			if (id >= sparse.size()) {
 				return false;
 			}
 			return sparse[id] != null_value && dense[sparse[id]] == e;
 		}
 
+		//first step of has(): the sparse slot of the id
+		void prefetch_sparse(size_t id)const {
+			if (id < sparse.size()) {
+				MYECS_PREFETCH(&sparse[id]);
+			}
+		}
+
+		//second step of has(): the dense slot, reads the sparse slot so prefetch that earlier
+		void prefetch_dense(size_t id)const {
+			if (id < sparse.size() && sparse[id] != null_value) {
+				MYECS_PREFETCH(&dense[sparse[id]]);
+			}
+		}
+
+		//live entries
 		size_t size()const {
+			return dense.size() - tombstones;
+		}
+
+		//dense entries with the tombstones, the length of data()
+		size_t extent()const {
 			return dense.size();
 		}
 
+		size_t tombstone_count()const {
+			return tombstones;
+		}
+
+		//the dense entries, tombstones included
+		const entity* data()const {
+			return dense.begin();
+		}
+
 		size_t max_value_size()const {
 			return sparse.size();
 		}
 
-		const_iterator begin() const { return dense.begin(); }
-		const_iterator end() const { return dense.end(); }
+		size_t dense_memory()const {
+			return dense.memory_usage();
+		}
+
+		size_t sparse_memory()const {
+			return sparse.memory_usage();
+		}
+
+		size_t memory_usage()const {
+			return dense_memory() + sparse_memory();
+		}
+
+		const_iterator begin() const { return const_iterator(dense.begin(), dense.end()); }
+		const_iterator end() const { return const_iterator(dense.end(), dense.end()); }
 	};
 
 	template<class T>
@@ -392,6 +680,7 @@ namespace myecs {
 
 		T get() {
 			if (unused_id.empty()) {
+				MYECS_CHECK_ALLOCATION(sparse.size() == sparse.capacity());
 				sparse.emplace_back(true);
 				return m_count++;
 			}
@@ -429,15 +718,46 @@ namespace myecs {
 			m_count = 0;
 		}
 
+		//room for count ids without allocation
+		void reserve(size_t count) {
+			MYECS_CHECK_ALLOCATION(count > sparse.capacity());
+			sparse.reserve(count);
+			unused_id.reserve(count);
+		}
+
+		//exactly the ids below count handed out and none free, for pools that moved their objects there
+		void assign(size_t count) {
+			sparse.assign(count, Node{ true });
+			unused_id.clear();
+			m_count = count;
+			shrink();
+		}
+
+		void shrink() {
+			sparse.shrink_to_fit();
+			unused_id.shrink();
+		}
+
 		bool full()const {
 			return unused_id.empty();
 		}
+
+		//ids returned and waiting for reuse
+		size_t free_count()const {
+			return unused_id.size();
+		}
+
+		size_t memory_usage()const {
+			return unused_id.memory_usage() + sparse.capacity() * sizeof(Node);
+		}
 	};
 
-	template<>
-	class IdGen<entity> {
+	template<class Traits>
+	class IdGen<basic_entity<Traits>> {
 	private:
+		using entity = basic_entity<Traits>;
 		using u32 = types::u32;
+		static_assert(Traits::version_bits <= 32, "versions are kept in 32 bits");
 		static constexpr u32 invalid_id = -1;
 		struct Node {
 			bool valid = false;
@@ -458,29 +778,42 @@ namespace myecs {
 
 		entity get() {
 			if (unused_id.empty()) {
+				//checked in every build: past max_id the id bits wrap and alias live handles
+				if (m_count > Traits::max_id) {
+					throw std::runtime_error("out of entity ids");
+				}
+				MYECS_CHECK_ALLOCATION(sparse.size() == sparse.capacity());
 				sparse.emplace_back(true, 0u);
-				return entity(static_cast<u32>(m_count++), 0u);
+				return entity(m_count++, 0u);
 			}
 			size_t new_id = unused_id.top();
 			unused_id.pop();
 			m_count++;
 			sparse[new_id].valid = true;
-			return entity(static_cast<u32>(new_id), sparse[new_id].version);
+			return entity(new_id, sparse[new_id].version);
 		}
 
+		//versions wrap around within the version bits of the handle
 		void ret(entity e) {
 			if (active(e)) {
-				sparse[e.id].version++;
-				sparse[e.id].valid = false;
-				unused_id.push(e.id);
+				size_t id = e.get_id();
+				sparse[id].version = static_cast<u32>((sparse[id].version + 1) & Traits::version_mask);
+				sparse[id].valid = false;
+				unused_id.push(id);
 				m_count--;
 			}
 		}
 
 		bool active(entity e)const {
-			return e.id < sparse.size()
-				&& sparse[e.id].valid
-				&& sparse[e.id].version == e.version;
+			size_t id = e.get_id();
+			return id < sparse.size()
+				&& sparse[id].valid
+				&& sparse[id].version == e.get_version();
+		}
+
+		//the handle currently carrying this id, the id must have been handed out before
+		entity current(size_t id)const {
+			return entity(id, sparse[id].version);
 		}
 
 		size_t count()const {
@@ -497,9 +830,49 @@ namespace myecs {
 			m_count = 0;
 		}
 
+		//room for count ids without allocation
+		void reserve(size_t count) {
+			MYECS_CHECK_ALLOCATION(count > sparse.capacity());
+			sparse.reserve(count);
+			unused_id.reserve(count);
+		}
+
+		//moves the live ids down to [0, count()) in id order, keeping their versions, and calls func(old, new)
+		//for every live handle. freed ids are forgotten, so their stale handles may become valid again
+		template<class Func>
+		void pack(Func&& func) {
+			size_t next = 0;
+			for (size_t id = 0; id < sparse.size(); id++) {
+				if (!sparse[id].valid) {
+					continue;
+				}
+				sparse[next] = sparse[id];
+				func(entity(id, sparse[id].version), entity(next, sparse[id].version));
+				next++;
+			}
+			sparse.resize(next);
+			unused_id.clear();
+			shrink();
+		}
+
+		//keeps a node for every id ever handed out, the versions stop stale handles from becoming valid
+		void shrink() {
+			sparse.shrink_to_fit();
+			unused_id.shrink();
+		}
+
 		bool full()const {
 			return unused_id.empty();
 		}
+
+		//ids returned and waiting for reuse
+		size_t free_count()const {
+			return unused_id.size();
+		}
+
+		size_t memory_usage()const {
+			return unused_id.memory_usage() + sparse.capacity() * sizeof(Node);
+		}
 	};
 
 }//namespace myecs
@@ -3,6 +3,7 @@
 #define MYECS_DENSE_MAP
 
 #include"container.h"
+#include"profile.h"
 #include"utils.h"
 #include<string>
 
@@ -82,7 +83,7 @@ namespace myecs {
 		static constexpr size_t invalid_index = std::numeric_limits<size_t>::max();
 
 		template<class _Key>
-		size_t get_bucket(const _Key& key) {
+		size_t get_bucket(const _Key& key)const {
 			return fast_mod(myHash(key), bucket_count());
 		}
 
@@ -97,6 +98,9 @@ namespace myecs {
 		}
 
 		void rehash() {
+			MYECS_PROFILE_SCOPE("DenseMap::rehash");
+			MYECS_PROFILE_COUNT(rehash, 1);
+			MYECS_PROFILE_COUNT(bytes_moved, packed.size() * sizeof(Node));
 			Packed oldData;
 			oldData.swap(packed);
 			size_t new_size = sparse.size() * expand_factor;
@@ -114,6 +118,7 @@ namespace myecs {
 
 		template<class _Key = Key, class ...Args>
 		node_iterator emplace_no_check(size_t bucket, _Key&& key, Args&&...args) {
+			MYECS_CHECK_ALLOCATION(packed.size() == packed.capacity());
 			if (sparse[bucket] == invalid_index) {
 				sparse[bucket] = packed.size();
 				packed.emplace_back(Pair(std::forward<_Key>(key), Type(std::forward<Args>(args)...)));
@@ -143,6 +148,18 @@ namespace myecs {
 			return packed.end();
 		}
 
+		template<class _Key = Key>
+		const_node_iterator find(const _Key& key, size_t bucket)const {
+			size_t index = sparse[bucket];
+			while (index != invalid_index) {
+				if (myKeyeq(packed[index].pair.first, key)) {
+					return packed.begin() + index;
+				}
+				index = packed[index].next;
+			}
+			return packed.end();
+		}
+
 	public:
 		DenseMap() {
 			sparse.resize(min_bucket_size, invalid_index);
@@ -188,7 +205,9 @@ namespace myecs {
 
 		void clear() {
 			packed.clear();
+			sparse.clear();
 			sparse.resize(min_bucket_size, invalid_index);
+			update_should_rehash();
 		}
 
 		template<class _Key = Key>
@@ -197,6 +216,17 @@ namespace myecs {
 			return find(key, bucket);
 		}
 
+		template<class _Key = Key>
+		const_iterator find(const _Key& key)const {
+			size_t bucket = get_bucket(key);
+			return find(key, bucket);
+		}
+
+		template<class _Key = Key>
+		MYECS_NODISCARD bool contains(const _Key& key)const {
+			return find(key) != end();
+		}
+
 		template<class _Key = Key, class ...Args>
 		Pair& emplace_or_get(_Key&& key, Args&&...args) {
 			rehash_if_should();
@@ -0,0 +1,288 @@
+#pragma once
+#ifndef MYECS_DOUBLE_BUFFER_H
+#define MYECS_DOUBLE_BUFFER_H
+
+#include<algorithm>
+#include<cstring>
+#include<memory>
+#include<new>
+#include<span>
+#include<tuple>
+#include<vector>
+#include"pool.h"
+
+
+namespace myecs {
+
+	//double buffering is opt in per component type:
+	//template<> struct myecs::double_buffer_traits<Boid> :std::true_type {};
+	//Registry::get() then hands out the slot written during the current frame, Registry::previous() the value
+	//the last frame ended with, and Registry::swap_buffers() ends a frame.
+	//only emplace(), get(), try_get(), patch(), data() and each_span() count as writes and mark their slots for the next
+	//swap. each(), resume() and gather() pass const T& and mark nothing, like current() and previous()
+	template<class T>
+	struct double_buffer_traits :std::false_type {};
+
+	template<class T>
+	concept double_buffered_component = double_buffer_traits<T>::value;
+
+	namespace pool {
+		//two arrays of T over the same slots: writes go to the current one, reads of the last frame to the
+		//previous one. a flag byte per slot records writes, so threads writing different slots need no locks.
+		//the buffers sit behind one pointer so the pool keeps the size of a Pool<T>
+		template<class T>
+		class DoubleBufferedPool :public IPool {
+			static_assert(std::is_copy_constructible_v<T> && std::is_copy_assignable_v<T>, "double buffered components are copied between the buffers");
+
+		private:
+			struct alignas(T) Slot {
+				unsigned char bytes[sizeof(T)];
+			};
+
+			struct Buffers {
+				std::unique_ptr<Slot[]> data[2];
+				std::vector<unsigned char> written;
+				size_t current = 0;
+			};
+
+			std::unique_ptr<Buffers> buffers = std::make_unique<Buffers>();
+			size_t m_capacity = 0;
+			IdGen<size_t> ids;
+			GrowthPolicy growth;
+
+			T* slot(size_t buffer, size_t id) {
+				return std::launder(reinterpret_cast<T*>(&buffers->data[buffer][id]));
+			}
+
+			const T* slot(size_t buffer, size_t id)const {
+				return std::launder(reinterpret_cast<const T*>(&buffers->data[buffer][id]));
+			}
+
+			void reallocate(size_t new_capacity) {
+				MYECS_PROFILE_SCOPE("DoubleBufferedPool::grow");
+				MYECS_PROFILE_COUNT(reallocation, 1);
+				MYECS_PROFILE_COUNT(bytes_moved, 2 * ids.count() * sizeof(T));
+				MYECS_CHECK_ALLOCATION(true);
+				for (size_t k = 0; k < 2; k++) {
+					std::unique_ptr<Slot[]> data(new Slot[new_capacity]);
+					for (size_t i = 0; i < ids.max_count(); i++) {
+						if (ids.active(i)) {
+							new (&data[i]) T(std::move(*slot(k, i)));
+							slot(k, i)->~T();
+						}
+					}
+					buffers->data[k] = std::move(data);
+				}
+				buffers->written.resize(new_capacity, 0);
+				m_capacity = new_capacity;
+			}
+
+			void destroy_all() {
+				if constexpr (!std::is_trivially_destructible_v<T>) {
+					for (size_t i = 0; i < ids.max_count(); i++) {
+						if (ids.active(i)) {
+							slot(0, i)->~T();
+							slot(1, i)->~T();
+						}
+					}
+				}
+			}
+
+		public:
+			DoubleBufferedPool() {}
+			DoubleBufferedPool(DoubleBufferedPool&& other)noexcept :
+				buffers(std::move(other.buffers)),
+				m_capacity(other.m_capacity),
+				ids(std::move(other.ids)),
+				growth(other.growth) {
+				other.buffers = std::make_unique<Buffers>();
+				other.m_capacity = 0;
+			}
+			~DoubleBufferedPool() {
+				if (buffers) {
+					destroy_all();
+				}
+			}
+
+			//both buffers start with the new value
+			template<class ...Args>
+			size_t create(Args&&... args) {
+				if (ids.full() && ids.max_count() == m_capacity) {
+					reallocate(growth.next_capacity(m_capacity, m_capacity + 1));
+				}
+				size_t id = ids.get();
+				size_t current = buffers->current;
+				T* value = new (&buffers->data[current][id]) T(std::forward<Args>(args)...);
+				new (&buffers->data[current ^ 1][id]) T(*value);
+				buffers->written[id] = 0;
+				return id;
+			}
+
+			void create_bulk(size_t count, const T& value, size_t* out) {
+				reserve(std::max(m_capacity, ids.max_count() + count - std::min(count, ids.free_count())));
+				for (size_t i = 0; i < count; i++) {
+					out[i] = create(value);
+				}
+			}
+
+			bool valid(size_t id)const {
+				return ids.active(id);
+			}
+
+			//the slot of the current frame, marked as written
+			T& get(size_t id) {
+				buffers->written[id] = 1;
+				return *slot(buffers->current, id);
+			}
+
+			//the slot of the current frame, not marked
+			const T& get(size_t id)const {
+				return *slot(buffers->current, id);
+			}
+
+			T* try_get(size_t id) {
+				if (valid(id)) {
+					return &get(id);
+				}
+				return nullptr;
+			}
+
+			//slots the next swap() copies
+			size_t written_count()const {
+				return static_cast<size_t>(std::count(buffers->written.begin(), buffers->written.begin() + ids.max_count(), 1));
+			}
+
+			//the value the last frame ended with
+			const T& previous(size_t id)const {
+				return *slot(buffers->current ^ 1, id);
+			}
+
+			//slots [0, max_count()) of the current buffer, all of them marked as written
+			T* data() {
+				if (!m_capacity) {
+					return nullptr;
+				}
+				std::memset(buffers->written.data(), 1, ids.max_count());
+				return slot(buffers->current, 0);
+			}
+
+			void prefetch(size_t id)const {
+				if (id < m_capacity) {
+					MYECS_PREFETCH(&buffers->data[buffers->current][id]);
+				}
+			}
+
+			//slots [begin, begin + count) of the current buffer, marked as written
+			std::tuple<std::span<T>> spans(size_t begin, size_t count) {
+				std::memset(buffers->written.data() + begin, 1, count);
+				return { std::span<T>(slot(buffers->current, begin), count) };
+			}
+
+			//ends a frame: the buffers trade places, then the slots written during the frame are copied
+			//into the new current buffer, so that both hold the same values again. costs a scan of one
+			//byte per slot plus one copy per written slot
+			void swap() {
+				MYECS_PROFILE_SCOPE("DoubleBufferedPool::swap");
+				size_t current = buffers->current ^= 1;
+				unsigned char* written = buffers->written.data();
+				for (size_t i = 0; i < ids.max_count(); i++) {
+					if (written[i]) {
+						written[i] = 0;
+						if (ids.active(i)) {
+							*slot(current, i) = *slot(current ^ 1, i);
+						}
+					}
+				}
+			}
+
+			void destroy(size_t id) {
+				if (!valid(id)) {
+					return;
+				}
+				slot(0, id)->~T();
+				slot(1, id)->~T();
+				buffers->written[id] = 0;
+				ids.ret(id);
+			}
+
+			size_t count()const override {
+				return ids.count();
+			}
+
+			size_t max_count()const override {
+				return ids.max_count();
+			}
+
+			size_t free_count()const {
+				return ids.free_count();
+			}
+
+			size_t capacity()const {
+				return m_capacity;
+			}
+
+			void reserve(size_t count) {
+				if (count > m_capacity) {
+					reallocate(growth.reserve_capacity(count));
+				}
+				ids.reserve(count);
+			}
+
+			//same as Pool<T>::compact, for both buffers
+			template<class Func>
+			void compact(Func&& moved) {
+				MYECS_PROFILE_SCOPE("DoubleBufferedPool::compact");
+				size_t live = ids.count();
+				size_t hole = 0;
+				for (size_t from = live; from < ids.max_count(); from++) {
+					if (!ids.active(from)) {
+						continue;
+					}
+					while (ids.active(hole)) {
+						hole++;
+					}
+					for (size_t k = 0; k < 2; k++) {
+						new (&buffers->data[k][hole]) T(std::move(*slot(k, from)));
+						slot(k, from)->~T();
+					}
+					buffers->written[hole] = buffers->written[from];
+					moved(from, hole);
+					hole++;
+				}
+				ids.assign(live);
+				if (live == 0) {
+					buffers->data[0].reset();
+					buffers->data[1].reset();
+					buffers->written.clear();
+					m_capacity = 0;
+				}
+				else if (m_capacity > live) {
+					reallocate(live);
+				}
+				buffers->written.shrink_to_fit();
+			}
+
+			void set_growth(GrowthPolicy policy) {
+				growth = policy;
+			}
+
+			MYECS_NODISCARD GrowthPolicy growth_policy()const {
+				return growth;
+			}
+
+			size_t memory_usage()const {
+				return m_capacity * (2 * sizeof(Slot) + 1) + ids.memory_usage();
+			}
+
+			//keeps the storage for reuse
+			void clear() {
+				destroy_all();
+				std::fill(buffers->written.begin(), buffers->written.end(), 0);
+				ids.clear();
+			}
+		};
+	}//namespace pool
+
+}//namespace myecs
+
+#endif
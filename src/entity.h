@@ -3,11 +3,39 @@
 #define MYECS_ENTITY_H
 #include"component.h"
 #include"dense_map.h"
+#include"hierarchy.h"
+#include"prefab.h"
+#include"query.h"
+#include<array>
 //#include<memory_resource>
 
 
 namespace myecs {
 
+	//memory report of a whole Registry, see Registry::stats()
+	struct RegistryStats {
+		size_t entity_count = 0;
+		size_t max_entity_count = 0;
+		size_t entity_bytes = 0;		//id generator and per entity component sets
+		std::vector<PoolStats> pools;
+
+		MYECS_NODISCARD size_t component_count()const {
+			size_t ret = 0;
+			for (const auto& pool : pools) {
+				ret += pool.count;
+			}
+			return ret;
+		}
+
+		MYECS_NODISCARD size_t total_bytes()const {
+			size_t ret = entity_bytes;
+			for (const auto& pool : pools) {
+				ret += pool.total_bytes();
+			}
+			return ret;
+		}
+	};
+
 	//single thread only
 	//support move construct for components
 	//better use only one instance per program (but you dont have to)
@@ -28,11 +56,31 @@ namespace myecs {
 				return _id;
 			}
 
+			static id_type newComponentId() {
+				return component_id_reg++;
+			}
+
+			//component types seen so far by any registry
+			static id_type componentCount() {
+				return component_id_reg;
+			}
+
 		};
 
 		std::vector<ComponentPoolData> pools;
 		IdGen<entity> ids;
 		std::vector<SparseSet<id_type>> entity_components;
+		//keyed by the type hash of std::tuple<Types...>
+		DenseMap<size_t, QueryPlan> query_plans;
+		//registered persistent queries, keyed like query_plans, and the ones each component id feeds
+		std::vector<std::unique_ptr<PersistentQuery>> persistent_queries;
+		DenseMap<size_t, size_t> persistent_index;
+		std::vector<std::vector<PersistentQuery*>> query_listeners;
+		Hierarchy relations;
+		//entity count passed to reserve(), pools created later reserve their id indexed arrays for it
+		size_t reserved_entities = 0;
+		//next step of an interrupted compact(): a pool index, or pools.size() for the entity arrays
+		size_t compact_step = 0;
 
 		template<class T>
 		ComponentPool<T>& get_pool() {
@@ -43,6 +91,7 @@ namespace myecs {
 			ComponentPoolData& data = pools[component_id];
 			if (!data.has_value()) {
 				data.emplace<ComponentPool<T>>();
+				data.get()->reserve_ids(reserved_entities);
 			}
 			return *data.get<ComponentPool<T>>();
 		}
@@ -65,31 +114,62 @@ namespace myecs {
 			return const_cast<Registry*>(this)->try_get_pool<T>();
 		}
 
-		static IntVector<entity> get_common(std::initializer_list<const SparseSet<entity>*> archetypes) {
-			size_t min_size = SparseSet<entity>::_max_size;
-			const SparseSet<entity>* minSet = nullptr;
-			//std::cout << "archetype count: " << archetypes.size() << "\n";
-			for (auto* archetype : archetypes) {
-				//std::cout << "archetype size:" << archetype->size() << std::endl;
-				if (archetype->size() < min_size) {
-					min_size = archetype->size();
-					minSet = archetype;
-					//std::cout << "find option archetype, size=" << min_size << std::endl;
+		//any pool by component id, null if it was never created
+		const IComponentPool* try_get_pool(id_type cid)const {
+			if (cid >= pools.size() || !pools[cid].has_value()) {
+				return nullptr;
+			}
+			return pools[cid].get();
+		}
+
+		RuntimeComponentPool& get_runtime_pool(id_type cid) {
+			if constexpr (myecs_debug_level) {
+				if (!dynamic_cast<const RuntimeComponentPool*>(try_get_pool(cid))) {
+					throw std::runtime_error("not a runtime component");
 				}
 			}
-			if (!minSet) {
-				return {};
+			return *pools[cid].get<RuntimeComponentPool>();
+		}
+
+		//the component set of entity id, the list grows to hold it
+		SparseSet<id_type>& component_set(size_t id) {
+			if (entity_components.size() <= id) {
+				MYECS_CHECK_ALLOCATION(id >= entity_components.capacity());
+				entity_components.resize(id + 1);
+			}
+			return entity_components[id];
+		}
+
+		//query_plans key of a runtime view, type hashes of tuples are keyed the same way
+		static size_t runtime_query_key(std::span<const id_type> components) {
+			size_t ret = types::type_hash<RuntimeComponentPool>();
+			for (id_type cid : components) {
+				ret = (ret ^ cid) * 0x100000001b3ull;
 			}
+			return ret;
+		}
+
+		//iterates the driver of the plan and probes the other pools in plan order,
+		//then the excluded pools (null entries stand for pools that were never created)
+		static IntVector<entity> get_common(const IComponentPool* const* pools, const QueryPlan& plan,
+											const IComponentPool* const* excluded, size_t excluded_count) {
+			MYECS_PROFILE_SCOPE("Registry::get_common");
 			IntVector<entity> ret;
-			for (auto e : *minSet) {
+			size_t count = plan.order.size();
+			if (count == 0) {
+				return ret;
+			}
+			for (auto e : pools[plan.order[0]]->view()) {
 				bool ok = true;
-				for (auto* a : archetypes) {
-					if (a == minSet) continue;
-					if (!a->has(e)) {
+				for (size_t k = 1; k < count; k++) {
+					if (!pools[plan.order[k]]->has(e)) {
 						ok = false;
 						break;
 					}
 				}
+				for (size_t x = 0; ok && x < excluded_count; x++) {
+					ok = !(excluded[x] && excluded[x]->has(e));
+				}
 				if (ok) {
 					ret.emplace_back(e);
 				}
@@ -97,35 +177,291 @@ namespace myecs {
 			return ret;
 		}
 
+		//same result as get_common (in id order), but ANDs the occupancy bitmaps 256 bits at a time
+		//instead of probing every pool per entity, wins when the pools are dense and overlap a lot
+		IntVector<entity> get_common_bitmap(const IComponentPool* const* pools, size_t count,
+											const IComponentPool* const* excluded, size_t excluded_count)const {
+			MYECS_PROFILE_SCOPE("Registry::get_common_bitmap");
+			IntVector<const Bitmap*> bitmaps;
+			for (size_t i = 0; i < count; i++) {
+				bitmaps.emplace_back(&pools[i]->occupancy());
+			}
+			for (size_t x = 0; x < excluded_count; x++) {
+				if (excluded[x]) {
+					bitmaps.emplace_back(&excluded[x]->occupancy());
+				}
+			}
+			IntVector<entity> ret;
+			intersect(bitmaps.begin(), count, bitmaps.begin() + count, bitmaps.size() - count, [&](size_t id) {
+				ret.emplace_back(ids.current(id));
+			});
+			return ret;
+		}
+
+		IntVector<entity> run_query(const IComponentPool* const* pools, const QueryPlan& plan, QueryStrategy strategy,
+									const IComponentPool* const* excluded = nullptr, size_t excluded_count = 0)const {
+			if (strategy == QueryStrategy::bitmap) {
+				return get_common_bitmap(pools, plan.order.size(), excluded, excluded_count);
+			}
+			return get_common(pools, plan, excluded, excluded_count);
+		}
+
+		//get_pool may grow the pool vector, so every pool is created before any address is taken
+		template<class ...Types>
+		std::array<const IComponentPool*, sizeof...(Types)> get_pools() {
+			(get_pool<Types>(), ...);
+			return { (&get_pool<Types>())... };
+		}
+
+		template<class ...Types>
+		const QueryPlan& get_plan(const IComponentPool* const* query_pools) {
+			QueryPlan& plan = query_plans[types::type_hash<std::tuple<Types...>>()];
+			if (!plan.fits(query_pools, sizeof...(Types))) {
+				plan = QueryPlanner::make(query_pools, sizeof...(Types), ids.max_count());
+			}
+			return plan;
+		}
+
+		//e just got component cid, entity_components already lists it
+		void notify_emplace(entity e, id_type cid) {
+			if (cid >= query_listeners.size()) {
+				return;
+			}
+			const SparseSet<id_type>& owned = entity_components[e.get_id()];
+			for (PersistentQuery* query : query_listeners[cid]) {
+				query->checks++;
+				bool matches = true;
+				for (id_type c : query->components) {
+					matches = matches && owned.has(c);
+				}
+				if (matches) {
+					query->insert(e);
+				}
+			}
+		}
+
+		void notify_destroy(entity e, id_type cid) {
+			if (cid >= query_listeners.size()) {
+				return;
+			}
+			for (PersistentQuery* query : query_listeners[cid]) {
+				query->erase(e);
+			}
+		}
+
+		template<class ...Types>
+		PersistentQuery* find_persistent() {
+			auto it = persistent_index.find(types::type_hash<std::tuple<Types...>>());
+			if (it == persistent_index.end()) {
+				return nullptr;
+			}
+			return persistent_queries[it->second].get();
+		}
+
+		//the last step of compact(): component sets, id generator, hierarchy and persistent queries
+		void compact_entities() {
+			reserved_entities = 0;
+			if (entity_components.size() > ids.max_count()) {
+				entity_components.resize(ids.max_count());
+			}
+			for (auto& components : entity_components) {
+				components.shrink();
+			}
+			entity_components.shrink_to_fit();
+			ids.shrink();
+			relations.shrink();
+			for (auto& query : persistent_queries) {
+				query->matches.shrink();
+			}
+		}
+
+		void destroy_batches(const std::vector<IntVector<entity>>& batches) {
+			for (id_type cid = 0; cid < batches.size(); cid++) {
+				const IntVector<entity>& batch = batches[cid];
+				if (batch.size() == 0) {
+					continue;
+				}
+				MYECS_PROFILE_COUNT(component_destroy, batch.size());
+				pools[cid].get()->destroy_bulk(batch.begin(), batch.size());
+				if (cid < query_listeners.size() && !query_listeners[cid].empty()) {
+					for (entity e : batch) {
+						notify_destroy(e, cid);
+					}
+				}
+			}
+		}
+
+		//auto_prefetch turns into no prefetching while the index arrays and storage of the pools fit
+		//in prefetch_threshold_bytes, default_prefetch_distance above that
+		template<size_t N>
+		static size_t pick_prefetch_distance(const std::array<const IComponentPool*, N>& query_pools, size_t requested) {
+			if (requested != auto_prefetch) {
+				return requested;
+			}
+			size_t bytes = 0;
+			for (const IComponentPool* p : query_pools) {
+				PoolStats s = p->stats();
+				bytes += s.sparse_bytes + s.dense_bytes + s.storage_bytes;
+			}
+			return bytes < prefetch_threshold_bytes ? 0 : default_prefetch_distance;
+		}
+
+		//entities must all own every one of Types, tombstones of in_place sets are skipped
+		template<class ...Types, class Func>
+		void each_prefetched(const entity* entities, size_t n, size_t k, Func&& func) {
+			std::tuple<ComponentPool<Types>&...> query_pools = { get_pool<Types>()... };
+			for (size_t i = 0; i < n; i++) {
+				if (entities[i] == SparseSet<entity>::tombstone) {
+					continue;
+				}
+				if (k) {
+					if (i + 2 * k < n) {
+						std::apply([e = entities[i + 2 * k]](auto&... pools) {
+							(pools.prefetch_index(e), ...);
+						}, query_pools);
+					}
+					if (i + k < n) {
+						std::apply([e = entities[i + k]](auto&... pools) {
+							(pools.prefetch_component(e), ...);
+						}, query_pools);
+					}
+				}
+				std::apply([&](auto&... pools) {
+					func(entities[i], pools.read(entities[i])...);
+				}, query_pools);
+			}
+		}
+
 		Registry(const Registry&) = delete;
 
 	public:
+		//pass as prefetch distance to Registry::each to pick it from the pool sizes
+		static constexpr size_t auto_prefetch = std::numeric_limits<size_t>::max();
+		//below this many bytes of index arrays and storage the pools are assumed to be cached
+		static constexpr size_t prefetch_threshold_bytes = 1 << 20;
+		static constexpr size_t default_prefetch_distance = 16;
+		//entities between two clock reads in Registry::resume
+		static constexpr size_t cursor_clock_interval = 32;
+
+		//dense id of a component type, the index of its pool
+		template<class T>
+		MYECS_NODISCARD static id_type component_id() {
+			return _ComponentRegistry::getComponentId<T>();
+		}
+
 		explicit Registry() = default;
 		Registry(Registry&& other) noexcept :
 			pools(std::move(other.pools)),
 			ids(std::move(other.ids)),
-			entity_components(std::move(other.entity_components)) {
+			entity_components(std::move(other.entity_components)),
+			query_plans(std::move(other.query_plans)),
+			persistent_queries(std::move(other.persistent_queries)),
+			persistent_index(std::move(other.persistent_index)),
+			query_listeners(std::move(other.query_listeners)),
+			relations(std::move(other.relations)),
+			reserved_entities(other.reserved_entities),
+			compact_step(other.compact_step) {
 		}
 
 		//warning: when you emplace new component, the reference may expire!
+		//returns T&, or SoaRef<T> for soa components
 		template<class T, class ...Args>
-		T& emplace(entity e, Args&&... args) {
+		decltype(auto) emplace(entity e, Args&&... args) {
 			if constexpr (myecs_debug_level) {
 				if (!ids.active(e)) {
 					throw std::runtime_error("invalid entity");
 				}
 			}
-			size_t id = e.get_id();
-			if (entity_components.size() <= id) {
-				entity_components.resize(id + 1);
-			}
-			entity_components[id].insert(_ComponentRegistry::getComponentId<T>());
+			id_type cid = _ComponentRegistry::getComponentId<T>();
 			ComponentPool<T>& pool = get_pool<T>();
-			return pool.create(e, std::forward<Args>(args)...);
+			//the component exists before anything lists it, a throwing create leaves no trace
+			decltype(auto) ret = pool.create(e, std::forward<Args>(args)...);
+			component_set(e.get_id()).insert(cid);
+			notify_emplace(e, cid);
+			return ret;
+		}
+
+		//a copy of value for each of count entities, one pass per array instead of count emplace calls
+		template<class T>
+		void emplace_bulk(const entity* entities, size_t count, const T& value) {
+			if constexpr (myecs_debug_level) {
+				for (size_t i = 0; i < count; i++) {
+					if (!ids.active(entities[i])) {
+						throw std::runtime_error("invalid entity");
+					}
+				}
+			}
+			id_type cid = _ComponentRegistry::getComponentId<T>();
+			//throws before anything changed if an entity already owns T
+			get_pool<T>().create_bulk(entities, count, value);
+			for (size_t i = 0; i < count; i++) {
+				component_set(entities[i].get_id()).insert(cid);
+			}
+			if (cid < query_listeners.size() && !query_listeners[cid].empty()) {
+				for (size_t i = 0; i < count; i++) {
+					notify_emplace(entities[i], cid);
+				}
+			}
+		}
+
+		//count new entities carrying every component of prefab
+		MYECS_NODISCARD IntVector<entity> instantiate(const Prefab& prefab, size_t count) {
+			MYECS_PROFILE_SCOPE("Registry::instantiate");
+			IntVector<entity> ret;
+			ret.resize(count);
+			size_t max_id = 0;
+			for (size_t i = 0; i < count; i++) {
+				ret[i] = ids.get();
+				max_id = std::max<size_t>(max_id, ret[i].get_id());
+			}
+			if (count) {
+				component_set(max_id);
+			}
+			//every entity gets its whole component set at once, instead of growing it per emplace
+			IntVector<id_type> cids;
+			id_type max_cid = 0;
+			for (const auto& c : prefab.components) {
+				cids.emplace_back(c.component_id());
+				max_cid = std::max(max_cid, cids.back());
+			}
+			for (size_t i = 0; i < count && cids.size(); i++) {
+				SparseSet<id_type>& owned = entity_components[ret[i].get_id()];
+				owned.reserve(cids.size(), max_cid);
+				for (id_type cid : cids) {
+					owned.insert(cid);
+				}
+			}
+			try {
+				for (const auto& c : prefab.components) {
+					c.instantiate(*this, c.value.get(), ret.begin(), count);
+				}
+			}
+			catch (...) {
+				//a component that failed to stamp takes the whole batch with it: the components
+				//created so far, the pre-filled sets, query matches and the ids
+				for (id_type cid : cids) {
+					if (try_get_pool(cid)) {
+						pools[cid].get()->destroy_bulk(ret.begin(), count);
+					}
+					for (size_t i = 0; i < count; i++) {
+						notify_destroy(ret[i], cid);
+					}
+				}
+				for (size_t i = count; i-- > 0;) {
+					entity_components[ret[i].get_id()].clear();
+					ids.ret(ret[i]);
+				}
+				throw;
+			}
+			return ret;
+		}
+
+		MYECS_NODISCARD entity instantiate(const Prefab& prefab) {
+			return instantiate(prefab, 1)[0];
 		}
 
 		template<class T, class ...Args>
-		T& get_or_emplace(entity e, Args&&... args) {
+		decltype(auto) get_or_emplace(entity e, Args&&... args) {
 			ComponentPool<T>& pool = get_pool<T>();
 			if (pool.has(e)) {
 				return pool.get(e);
@@ -137,7 +473,7 @@ namespace myecs {
 
 		template<class ...Types>
 		decltype(auto) emplace_all(entity e, const Types&... types) {
-			return std::forward_as_tuple(emplace<Types>(e, types)...);
+			return std::tuple<decltype(emplace<Types>(e, types))...>(emplace<Types>(e, types)...);
 		}
 
 		template<class T>
@@ -155,8 +491,9 @@ namespace myecs {
 		}
 
 		//warning: when you emplace new component, the reference may expire!
+		//returns T&, or SoaRef<T> for soa components
 		template<class T>
-		MYECS_NODISCARD T& get(entity e) {
+		MYECS_NODISCARD decltype(auto) get(entity e) {
 			if constexpr (myecs_debug_level) {
 				if (!valid(e)) {
 					throw std::runtime_error("invalid entity");
@@ -167,6 +504,7 @@ namespace myecs {
 		}
 
 		template<class T>
+			requires (!soa_component<T>)
 		MYECS_NODISCARD T* try_get(entity e) {
 			if (!has<T>(e)) {
 				return nullptr;
@@ -184,11 +522,13 @@ namespace myecs {
 		void destroy(entity e) {
 			if (auto pool = try_get_pool<T>()) {
 				pool->destroy(e);
+				id_type cid = _ComponentRegistry::getComponentId<T>();
+				notify_destroy(e, cid);
 				size_t id = e.get_id();
 				if (entity_components.size() <= id) {
 					return;
 				}
-				entity_components[id].erase(_ComponentRegistry::getComponentId<T>());
+				entity_components[id].erase(cid);
 			}
 		}
 
@@ -200,29 +540,291 @@ namespace myecs {
 
 		template<class ...Types>
 			requires (sizeof...(Types) >= 2)
-		MYECS_NODISCARD std::tuple<Types&...> get(entity e) {
-			return std::forward_as_tuple(get<Types>(e)...);
+		MYECS_NODISCARD decltype(auto) get(entity e) {
+			return std::tuple<decltype(get<Types>(e))...>(get<Types>(e)...);
+		}
+
+		//the value of a double buffered component when the last frame ended, see double_buffer_traits.
+		//get() writes the current frame, so once the pool exists many threads can read any entity here
+		//and write their own ones through get() without locks, as long as no two threads write one entity
+		template<class T>
+			requires double_buffered_component<T>
+		MYECS_NODISCARD const T& previous(entity e) {
+			if constexpr (myecs_debug_level) {
+				if (!valid(e)) {
+					throw std::runtime_error("invalid entity");
+				}
+			}
+			return get_pool<T>().previous(e);
+		}
+
+		//the current frame's value of a double buffered component, read without marking it written
+		template<class T>
+			requires double_buffered_component<T>
+		MYECS_NODISCARD const T& current(entity e) {
+			if constexpr (myecs_debug_level) {
+				if (!valid(e)) {
+					throw std::runtime_error("invalid entity");
+				}
+			}
+			return get_pool<T>().read(e);
+		}
+
+		//ends the frame for Types: the values written by get() become the previous ones
+		template<class ...Types>
+			requires (sizeof...(Types) >= 1 && (double_buffered_component<Types> && ...))
+		void swap_buffers() {
+			(get_pool<Types>().swap_buffers(), ...);
+		}
+
+		//the way to change indexed fields: func receives get<T>(e), the indices of T follow the new value
+		template<class T, class Func>
+		decltype(auto) patch(entity e, Func&& func) {
+			if constexpr (myecs_debug_level) {
+				if (!valid(e)) {
+					throw std::runtime_error("invalid entity");
+				}
+			}
+			return get_pool<T>().patch(e, std::forward<Func>(func));
+		}
+
+		//hash index on a component field, e.g. hash_index<&Owner::player_id>(), built on first use
+		template<auto Member>
+		HashIndex<Member>& hash_index() {
+			return get_pool<indexed_component_t<Member>>().template index<HashIndex<Member>>();
+		}
+
+		//ordered index on a component field for range queries, built on first use
+		template<auto Member>
+		OrderedIndex<Member>& ordered_index() {
+			return get_pool<indexed_component_t<Member>>().template index<OrderedIndex<Member>>();
+		}
+
+		//entities whose field Member equals key, through hash_index<Member>()
+		template<auto Member>
+		MYECS_NODISCARD std::span<const entity> find_by(const indexed_key_t<Member>& key) {
+			return hash_index<Member>().find(key);
+		}
+
+		//entities whose field Member lies in [low, high], through ordered_index<Member>()
+		template<auto Member>
+		MYECS_NODISCARD IntVector<entity> find_range(const indexed_key_t<Member>& low, const indexed_key_t<Member>& high) {
+			return ordered_index<Member>().find(low, high);
+		}
+
+		template<auto Member, template<auto> class Index>
+		void drop_index() {
+			if (auto pool = try_get_pool<indexed_component_t<Member>>()) {
+				pool->template drop_index<Index<Member>>();
+			}
 		}
 
 		MYECS_NODISCARD entity create() {
 			return ids.get();
 		}
 
+		//room for entities live entities: the id generator, the list of component sets and the id indexed
+		//arrays of every pool, including pools created later. a component set keeps its memory when its id
+		//is reused, but grows when the new owner has more components than any earlier one. with
+		//components_per_entity set, every set is built up front with room for that many of the component
+		//types known so far
+		void reserve(size_t entities, size_t components_per_entity = 0) {
+			reserved_entities = std::max(reserved_entities, entities);
+			ids.reserve(entities);
+			MYECS_CHECK_ALLOCATION(entities > entity_components.capacity());
+			entity_components.reserve(entities);
+			if (components_per_entity && entities) {
+				component_set(entities - 1);
+				id_type max_cid = std::max<id_type>(_ComponentRegistry::componentCount(), 1) - 1;
+				for (auto& set : entity_components) {
+					set.reserve(components_per_entity, max_cid);
+				}
+			}
+			for (auto& pool : pools) {
+				if (pool.has_value()) {
+					pool.get()->reserve_ids(entities);
+				}
+			}
+		}
+
+		//storage for count components of T, see reserve(entities) for the id indexed arrays
+		template<class T>
+		void reserve(size_t count) {
+			get_pool<T>().reserve(count);
+		}
+
+		//how the storage of T grows from now on, e.g. GrowthPolicy::fixed(4096) to fail instead of reallocating
+		template<class T>
+		void set_growth(GrowthPolicy policy) {
+			get_pool<T>().set_growth(policy);
+		}
+
+		//DeletionPolicy::in_place() turns removing T into leaving a tombstone in the entity list of T, so
+		//view<T>() and each<T>() can run while entities are destroyed. the tombstones are purged when an insert
+		//finds more than the compact ratio of them, and at sync()
+		template<class T>
+		void set_deletion(DeletionPolicy policy) {
+			get_pool<T>().set_deletion(policy);
+		}
+
+		//a point where no view is iterated: drops the tombstones of every pool
+		void sync() {
+			MYECS_PROFILE_SCOPE("Registry::sync");
+			for (auto& pool : pools) {
+				if (pool.has_value()) {
+					pool.get()->purge();
+				}
+			}
+		}
+
+		//gives memory back after a load spike: every pool moves its components out of the tail of its storage
+		//and shrinks storage, dense and sparse arrays to fit, then the component sets, the id generator and the
+		//hierarchy shrink. a step is one pool or the entity arrays; with a budget the call returns after the step
+		//that ran out of time and the next call continues from there. returns true once every step is done.
+		//component references and spans expire, entity handles stay valid. reserve() is undone.
+		//the id generator keeps a node per id ever used, renumber() closes those gaps
+		bool compact(std::chrono::nanoseconds budget = {}) {
+			using clock = std::chrono::steady_clock;
+			MYECS_PROFILE_SCOPE("Registry::compact");
+			clock::time_point deadline = clock::now() + budget;
+			while (compact_step <= pools.size()) {
+				if (compact_step == pools.size()) {
+					compact_entities();
+				}
+				else if (pools[compact_step].has_value()) {
+					pools[compact_step].get()->compact();
+				}
+				compact_step++;
+				if (budget.count() && compact_step <= pools.size() && clock::now() >= deadline) {
+					return false;
+				}
+			}
+			compact_step = 0;
+			return true;
+		}
+
+		//moves the live entities down to ids [0, entity_count()) keeping their order and versions, and shrinks
+		//everything indexed by entity id. remap(old, new) is called for every changed handle once the registry
+		//is consistent again: handles kept outside, or inside components, must be translated there.
+		//stale handles may alias live entities afterwards, and cursors should be rewound
+		template<class Func>
+		void renumber(Func&& remap) {
+			MYECS_PROFILE_SCOPE("Registry::renumber");
+			IntVector<entity> to;
+			to.resize(ids.max_count(), null_entity);
+			IntVector<entity> moved;
+			ids.pack([&](entity old, entity now) {
+				to[old.get_id()] = now;
+				if (old != now) {
+					moved.emplace_back(old);
+				}
+			});
+			size_t sets = std::min(entity_components.size(), to.size());
+			for (size_t id = 0; id < sets; id++) {
+				if (to[id] != null_entity && to[id].get_id() != id) {
+					std::swap(entity_components[to[id].get_id()], entity_components[id]);
+				}
+			}
+			entity_components.resize(std::min(entity_components.size(), ids.count()));
+			for (auto& pool : pools) {
+				if (pool.has_value()) {
+					pool.get()->renumber(to);
+				}
+			}
+			auto rename = [&](entity e) {
+				return to[e.get_id()];
+			};
+			relations.remap(rename);
+			for (auto& query : persistent_queries) {
+				query->matches.remap(rename);
+			}
+			compact_entities();
+			for (entity old : moved) {
+				remap(old, to[old.get_id()]);
+			}
+		}
+
 		void destroy(entity e) {
 			if (!ids.active(e)) {
 				return;
 			}
 			ids.ret(e);
-			size_t id = static_cast<size_t>(e.id);
+			relations.erase(e);
+			size_t id = e.get_id();
 			if (entity_components.size() <= id) {
 				return;
 			}
+			MYECS_PROFILE_SCOPE("Registry::destroy");
+			MYECS_PROFILE_COUNT(entity_destroy, 1);
+			MYECS_PROFILE_COUNT(component_destroy, entity_components[id].size());
 			for (auto cid : entity_components[id]) {
 				pools[cid].get()->destroy(e);
+				notify_destroy(e, cid);
 			}
 			entity_components[id].clear();
 		}
 
+		//destroys a range of entities with one batched erase per pool instead of one virtual call
+		//per component, pools losing every component are cleared, and one pass over the hierarchy.
+		//invalid entities are skipped
+		template<class It>
+		void destroy(It first, It last) {
+			MYECS_PROFILE_SCOPE("Registry::destroy_bulk");
+			//copied first: the range may be a view into a pool emptied below
+			IntVector<entity> dead;
+			for (; first != last; ++first) {
+				entity e = *first;
+				if (ids.active(e)) {
+					ids.ret(e);
+					dead.emplace_back(e);
+				}
+			}
+			relations.erase_bulk(std::span<const entity>(dead.begin(), dead.size()));
+			std::vector<IntVector<entity>> batches(pools.size());
+			for (entity e : dead) {
+				size_t id = e.get_id();
+				if (id >= entity_components.size()) {
+					continue;
+				}
+				for (auto cid : entity_components[id]) {
+					batches[cid].emplace_back(e);
+				}
+				entity_components[id].clear();
+			}
+			MYECS_PROFILE_COUNT(entity_destroy, dead.size());
+			destroy_batches(batches);
+		}
+
+		//removes T from a range of entities, entities without T are skipped
+		template<class T, class It>
+		void remove(It first, It last) {
+			ComponentPool<T>* pool = try_get_pool<T>();
+			if (!pool) {
+				return;
+			}
+			id_type cid = _ComponentRegistry::getComponentId<T>();
+			IntVector<entity> batch;
+			for (; first != last; ++first) {
+				entity e = *first;
+				size_t id = e.get_id();
+				//erasing cid right away also drops duplicates
+				if (pool->has(e) && id < entity_components.size() && entity_components[id].has(cid)) {
+					entity_components[id].erase(cid);
+					batch.emplace_back(e);
+				}
+			}
+			pool->destroy_bulk(batch.begin(), batch.size());
+			for (entity e : batch) {
+				notify_destroy(e, cid);
+			}
+		}
+
+		//destroys every entity of a view, e.g. destroy_all(view<Projectile, Expired>())
+		template<class View>
+		void destroy_all(const View& view) {
+			destroy(view.begin(), view.end());
+		}
+
 		MYECS_NODISCARD bool valid(entity e)const {
 			return ids.active(e);
 		}
@@ -232,18 +834,476 @@ namespace myecs {
 			return get_pool<T>().view();
 		}
 
+		//evaluated with the cached plan of this component set, see QueryPlanner
+		template<class ...Types>
+			requires (sizeof...(Types) >= 2)
+		MYECS_NODISCARD IntVector<entity> view() {
+			auto query_pools = get_pools<Types...>();
+			const QueryPlan& plan = get_plan<Types...>(query_pools.data());
+			return run_query(query_pools.data(), plan, plan.strategy);
+		}
+
+		//planned probe order, but the strategy is forced
+		template<class ...Types>
+			requires (sizeof...(Types) >= 2)
+		MYECS_NODISCARD IntVector<entity> view(QueryStrategy strategy) {
+			auto query_pools = get_pools<Types...>();
+			return run_query(query_pools.data(), get_plan<Types...>(query_pools.data()), strategy);
+		}
+
+		//excluded pools are looked up once, a component type that was never emplaced excludes nothing
+		template<class ...Types, class ...Excluded>
+			requires (sizeof...(Types) >= 1)
+		MYECS_NODISCARD IntVector<entity> view(exclude_t<Excluded...>) {
+			auto query_pools = get_pools<Types...>();
+			const QueryPlan& plan = get_plan<Types...>(query_pools.data());
+			std::array<const IComponentPool*, sizeof...(Excluded)> excluded = { try_get_pool<Excluded>()... };
+			return run_query(query_pools.data(), plan, plan.strategy, excluded.data(), excluded.size());
+		}
+
+		template<class ...Types, class ...Excluded>
+			requires (sizeof...(Types) >= 1)
+		MYECS_NODISCARD IntVector<entity> view(exclude_t<Excluded...>, QueryStrategy strategy) {
+			auto query_pools = get_pools<Types...>();
+			std::array<const IComponentPool*, sizeof...(Excluded)> excluded = { try_get_pool<Excluded>()... };
+			return run_query(query_pools.data(), get_plan<Types...>(query_pools.data()), strategy, excluded.data(), excluded.size());
+		}
+
+		template<class ...Types>
+			requires (sizeof...(Types) >= 2)
+		MYECS_NODISCARD IntVector<entity> bitmap_view() {
+			return view<Types...>(QueryStrategy::bitmap);
+		}
+
 		template<class ...Types>
 			requires (sizeof...(Types) >= 2)
-		MYECS_NODISCARD decltype(auto) view() {
-			return get_common({ (&view<Types>())... });
+		MYECS_NODISCARD const QueryPlan& plan() {
+			auto query_pools = get_pools<Types...>();
+			return get_plan<Types...>(query_pools.data());
+		}
+
+		//calls func(entity, components...) for the entities of the persistent query of Types if there is one,
+		//else the planned view<Types...>(), or the dense order of the pool for a single type.
+		//while visiting entity i the index slots of entity i + 2k and the component slots of entity i + k
+		//are prefetched in every pool, k = prefetch_distance (0 turns it off).
+		//func must not add or remove components of Types, except that for a single type with in_place deletion
+		//(see set_deletion) it may destroy entities and remove T: those not visited yet are skipped
+		template<class ...Types, class Func>
+			requires (sizeof...(Types) >= 1)
+		void each(Func&& func, size_t prefetch_distance = auto_prefetch) {
+			auto query_pools = get_pools<Types...>();
+			size_t k = pick_prefetch_distance(query_pools, prefetch_distance);
+			if constexpr (sizeof...(Types) == 1) {
+				const SparseSet<entity>& set = query_pools[0]->view();
+				each_prefetched<Types...>(set.data(), set.extent(), k, std::forward<Func>(func));
+			}
+			else if (PersistentQuery* query = find_persistent<Types...>()) {
+				query->reads++;
+				each_prefetched<Types...>(query->matches.data(), query->matches.extent(), k, std::forward<Func>(func));
+			}
+			else {
+				const QueryPlan& plan = get_plan<Types...>(query_pools.data());
+				IntVector<entity> entities = run_query(query_pools.data(), plan, plan.strategy);
+				each_prefetched<Types...>(entities.begin(), entities.size(), k, std::forward<Func>(func));
+			}
+		}
+
+		//copies the Types components of a list of entities into one contiguous array per type:
+		//out[k] receives the component of entities[k]. the pools are looked up once and the slots
+		//of later entities are prefetched as in each(). every entity must own all of Types
+		template<class ...Types>
+			requires (sizeof...(Types) >= 1)
+		void gather(std::span<const entity> entities, Types*... out, size_t prefetch_distance = auto_prefetch) {
+			MYECS_PROFILE_SCOPE("Registry::gather");
+			size_t k = pick_prefetch_distance(get_pools<Types...>(), prefetch_distance);
+			size_t i = 0;
+			each_prefetched<Types...>(entities.data(), entities.size(), k, [&](entity, auto&&... values) {
+				((out[i] = values), ...);
+				i++;
+			});
+		}
+
+		//the way back from gather: the component of entities[k] is assigned in[k], for every one of Types.
+		//secondary indices are not updated, use patch() for indexed fields
+		template<class ...Types>
+			requires (sizeof...(Types) >= 1)
+		void scatter(std::span<const entity> entities, const Types*... in, size_t prefetch_distance = auto_prefetch) {
+			MYECS_PROFILE_SCOPE("Registry::scatter");
+			size_t k = pick_prefetch_distance(get_pools<Types...>(), prefetch_distance);
+			size_t i = 0;
+			each_prefetched<Types...>(entities.data(), entities.size(), k, [&](entity, auto&&... values) {
+				((values = in[i]), ...);
+				i++;
+			});
+		}
+
+		//orders entities by the storage slot of their T, so that gather and scatter read T front to back.
+		//the sort costs more than one gather of a random list, it pays off for lists used several times
+		//(gathered and scattered, or kept across frames). every entity must own T
+		template<class T>
+		void sort_by_storage(std::span<entity> entities) {
+			ComponentPool<T>& pool = get_pool<T>();
+			//one slot lookup per entity, not per comparison
+			std::vector<std::pair<size_t, entity>> keyed(entities.size());
+			for (size_t i = 0; i < entities.size(); i++) {
+				keyed[i] = { pool.slot_of(entities[i]), entities[i] };
+			}
+			std::sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b) {
+				return a.first < b.first;
+			});
+			for (size_t i = 0; i < entities.size(); i++) {
+				entities[i] = keyed[i].second;
+			}
+		}
+
+		//registers a query whose matches are kept current on every emplace and destroy of Types,
+		//so reading it is a linear scan. built from a planned view the first time
+		template<class ...Types>
+			requires (sizeof...(Types) >= 1)
+		const PersistentQuery& persist() {
+			if (PersistentQuery* query = find_persistent<Types...>()) {
+				return *query;
+			}
+			auto query = std::make_unique<PersistentQuery>();
+			(query->components.emplace_back(_ComponentRegistry::getComponentId<Types>()), ...);
+			for (auto e : view<Types...>()) {
+				query->insert(e);
+			}
+			for (id_type cid : query->components) {
+				if (query_listeners.size() <= cid) {
+					query_listeners.resize(cid + 1);
+				}
+				query_listeners[cid].push_back(query.get());
+			}
+			persistent_index[types::type_hash<std::tuple<Types...>>()] = persistent_queries.size();
+			persistent_queries.push_back(std::move(query));
+			return *persistent_queries.back();
+		}
+
+		//matches of the persistent query of Types, registering it on first use.
+		//emplacing or destroying one of Types reorders the set, so do not while iterating it
+		template<class ...Types>
+			requires (sizeof...(Types) >= 1)
+		MYECS_NODISCARD archetype_view persistent_view() {
+			persist<Types...>();
+			PersistentQuery* query = find_persistent<Types...>();
+			query->reads++;
+			return query->matches;
+		}
+
+		//maintenance report next to the planner's estimate for a fresh view, to judge whether
+		//the query deserves to stay persistent. empty for unregistered queries
+		template<class ...Types>
+			requires (sizeof...(Types) >= 1)
+		MYECS_NODISCARD PersistentQueryStats query_stats() {
+			PersistentQuery* query = find_persistent<Types...>();
+			if (!query) {
+				return {};
+			}
+			PersistentQueryStats ret = query->stats();
+			auto query_pools = get_pools<Types...>();
+			if constexpr (sizeof...(Types) == 1) {
+				ret.query_cost = static_cast<double>(query_pools[0]->count()) * QueryPlanner::iterate_cost;
+			}
+			else {
+				ret.query_cost = get_plan<Types...>(query_pools.data()).estimated_cost;
+			}
+			return ret;
+		}
+
+		//registers a component type described at runtime and returns its component id. the components
+		//get the same pooled storage as C++ types and are reached through the id_type overloads below
+		MYECS_NODISCARD id_type add_component(pool::TypeInfo info) {
+			id_type cid = _ComponentRegistry::newComponentId();
+			if (pools.size() <= cid) {
+				pools.resize(cid + 1);
+			}
+			pools[cid].emplace<RuntimeComponentPool>(std::make_shared<const pool::TypeInfo>(std::move(info)));
+			pools[cid].get()->reserve_ids(reserved_entities);
+			return cid;
+		}
+
+		MYECS_NODISCARD const pool::TypeInfo& component_info(id_type cid) {
+			return get_runtime_pool(cid).type();
+		}
+
+		//runtime component cid moved from value, or constructed by its type info for null
+		void* emplace(entity e, id_type cid, void* value = nullptr) {
+			if constexpr (myecs_debug_level) {
+				if (!ids.active(e)) {
+					throw std::runtime_error("invalid entity");
+				}
+			}
+			RuntimeComponentPool& pool = get_runtime_pool(cid);
+			void* ret = pool.create(e, value);
+			component_set(e.get_id()).insert(cid);
+			notify_emplace(e, cid);
+			return ret;
+		}
+
+		//any component id, runtime or component_id<T>()
+		MYECS_NODISCARD bool has(entity e, id_type cid)const {
+			const IComponentPool* pool = try_get_pool(cid);
+			return pool && pool->has(e);
+		}
+
+		MYECS_NODISCARD void* get(entity e, id_type cid) {
+			if constexpr (myecs_debug_level) {
+				if (!valid(e)) {
+					throw std::runtime_error("invalid entity");
+				}
+			}
+			return get_runtime_pool(cid).get(e);
+		}
+
+		MYECS_NODISCARD void* try_get(entity e, id_type cid) {
+			if (!has(e, cid)) {
+				return nullptr;
+			}
+			return get(e, cid);
+		}
+
+		//any component id, runtime or component_id<T>()
+		void destroy(entity e, id_type cid) {
+			if (!try_get_pool(cid)) {
+				return;
+			}
+			pools[cid].get()->destroy(e);
+			notify_destroy(e, cid);
+			size_t id = e.get_id();
+			if (entity_components.size() <= id) {
+				return;
+			}
+			entity_components[id].erase(cid);
+		}
+
+		MYECS_NODISCARD archetype_view view(id_type cid)const {
+			static const SparseSet<entity> empty;
+			const IComponentPool* pool = try_get_pool(cid);
+			return pool ? pool->view() : empty;
+		}
+
+		//view over component ids known at runtime, planned like view<Types...>() and cached per id list.
+		//runtime and C++ component ids can be mixed
+		MYECS_NODISCARD IntVector<entity> view(std::span<const id_type> components, std::span<const id_type> excluded = {}) {
+			IntVector<const IComponentPool*> query_pools;
+			for (id_type cid : components) {
+				const IComponentPool* pool = try_get_pool(cid);
+				if (!pool) {
+					return {};
+				}
+				query_pools.emplace_back(pool);
+			}
+			IntVector<const IComponentPool*> excluded_pools;
+			for (id_type cid : excluded) {
+				excluded_pools.emplace_back(try_get_pool(cid));
+			}
+			QueryPlan& plan = query_plans[runtime_query_key(components)];
+			if (!plan.fits(query_pools.begin(), components.size())) {
+				plan = QueryPlanner::make(query_pools.begin(), components.size(), ids.max_count());
+			}
+			return run_query(query_pools.begin(), plan, plan.strategy, excluded_pools.begin(), excluded.size());
+		}
+
+		//calls func(entity, std::span<void* const>) with one pointer per runtime component, in the order of components.
+		//func must not add or remove components of the view
+		template<class Func>
+		void each(std::span<const id_type> components, Func&& func) {
+			IntVector<RuntimeComponentPool*> query_pools;
+			for (id_type cid : components) {
+				query_pools.emplace_back(&get_runtime_pool(cid));
+			}
+			IntVector<void*> values;
+			values.resize(components.size());
+			auto visit = [&](entity e) {
+				for (size_t k = 0; k < components.size(); k++) {
+					values[k] = query_pools[k]->get(e);
+				}
+				func(e, std::span<void* const>(values.begin(), components.size()));
+			};
+			if (components.size() == 1) {
+				for (entity e : query_pools[0]->view()) {
+					visit(e);
+				}
+				return;
+			}
+			for (entity e : view(components)) {
+				visit(e);
+			}
+		}
+
+		//parent/child relations in depth first order, destroyed entities leave it on their own
+		MYECS_NODISCARD Hierarchy& hierarchy() {
+			return relations;
+		}
+
+		//parent null_entity makes e a root, see Hierarchy::set_parent
+		void set_parent(entity e, entity parent) {
+			if constexpr (myecs_debug_level) {
+				if (!valid(e) || (parent != null_entity && !valid(parent))) {
+					throw std::runtime_error("invalid entity");
+				}
+			}
+			relations.set_parent(e, parent);
+		}
+
+		MYECS_NODISCARD entity parent(entity e)const {
+			return relations.parent(e);
+		}
+
+		//calls func(const T* parent, T& node) for every hierarchy node owning T in depth first order,
+		//so a parent is always done before its children. parent is null for roots and for nodes
+		//whose parent has no T
+		template<class T, class Func>
+			requires (!soa_component<T>)
+		void propagate(Func&& func) {
+			MYECS_PROFILE_SCOPE("Registry::propagate");
+			ComponentPool<T>& pool = get_pool<T>();
+			std::span<const entity> order = relations.order();
+			IntVector<T*> values;
+			values.resize(order.size());
+			for (size_t i = 0; i < order.size(); i++) {
+				values[i] = pool.has(order[i]) ? &pool.get(order[i]) : nullptr;
+				if (i + default_prefetch_distance < order.size()) {
+					pool.prefetch_component(order[i + default_prefetch_distance]);
+				}
+			}
+			for (size_t i = 0; i < order.size(); i++) {
+				if (!values[i]) {
+					continue;
+				}
+				size_t p = relations.parent_index(i);
+				func(static_cast<const T*>(p == Hierarchy::npos ? nullptr : values[p]), *values[i]);
+			}
+		}
+
+		//continues cursor's pass over the entities owning all Types, in id order, calling func(entity, components...)
+		//until the budget runs out or the pass ends. returns the number of entities visited by this call.
+		//the clock is read every cursor_clock_interval entities, so a time budget may overrun by that many.
+		//func may destroy entities and components, but must not emplace a component type the registry never had
+		template<class ...Types, class Func>
+			requires (sizeof...(Types) >= 1)
+		size_t resume(ViewCursor<Types...>& cursor, CursorBudget budget, Func&& func) {
+			using clock = std::chrono::steady_clock;
+			MYECS_PROFILE_SCOPE("Registry::resume");
+			auto query_pools = get_pools<Types...>();
+			std::tuple<ComponentPool<Types>&...> typed_pools = { get_pool<Types>()... };
+			std::array<const Bitmap*, sizeof...(Types)> bitmaps;
+			size_t words = std::numeric_limits<size_t>::max();
+			for (size_t i = 0; i < sizeof...(Types); i++) {
+				bitmaps[i] = &query_pools[i]->occupancy();
+				words = std::min(words, bitmaps[i]->word_count());
+			}
+			clock::time_point deadline = clock::now() + budget.max_time;
+			size_t limit = budget.max_entities ? budget.max_entities : std::numeric_limits<size_t>::max();
+			size_t done = 0;
+
+			size_t w = cursor.next_id / Bitmap::word_bits;
+			//bits below the cursor in its first word were visited already
+			Bitmap::word_type mask = ~Bitmap::word_type(0) << (cursor.next_id % Bitmap::word_bits);
+			for (; w < words; w++, mask = ~Bitmap::word_type(0)) {
+				Bitmap::word_type acc = mask;
+				for (const Bitmap* bitmap : bitmaps) {
+					acc &= bitmap->word(w);
+				}
+				while (acc) {
+					if (done == limit) {
+						return done;
+					}
+					if (budget.max_time.count() && done && done % cursor_clock_interval == 0 && clock::now() >= deadline) {
+						return done;
+					}
+					size_t id = w * Bitmap::word_bits + static_cast<size_t>(std::countr_zero(acc));
+					acc &= acc - 1;
+					cursor.next_id = id + 1;
+					//an earlier call of func may have removed this one
+					bool alive = true;
+					for (const Bitmap* bitmap : bitmaps) {
+						alive = alive && bitmap->test(id);
+					}
+					if (!alive) {
+						continue;
+					}
+					entity e = ids.current(id);
+					std::apply([&](auto&... pools) {
+						func(e, pools.read(e)...);
+					}, typed_pools);
+					done++;
+					cursor.visited_count++;
+				}
+				cursor.next_id = std::max(cursor.next_id, (w + 1) * Bitmap::word_bits);
+			}
+			cursor.next_id = 0;
+			cursor.visited_count = 0;
+			cursor.pass_count++;
+			return done;
+		}
+
+		//func(std::span<const entity>, std::span<T>) over runs of contiguous storage, see ComponentPool::each_span
+		//soa components get one span per field instead of std::span<T>
+		template<class T, class Func>
+		void each_span(Func&& func) {
+			get_pool<T>().each_span(std::forward<Func>(func));
+		}
+
+		//func(std::span<const entity>, std::span<First>, std::span<Others>...)
+		//runs follow the storage of First and are cut wherever another pool keeps the same entity in a
+		//different slot, such entities are passed one by one with spans of size 1.
+		//pools filled in lockstep (all components emplaced at spawn) line up completely
+		template<class First, class ...Others, class Func>
+			requires (sizeof...(Others) >= 1 && !soa_component<First> && (!soa_component<Others> && ...))
+		void each_span(Func&& func) {
+			(get_pool<Others>(), ...);
+			ComponentPool<First>& driver = get_pool<First>();
+			std::tuple<ComponentPool<Others>&...> others = { get_pool<Others>()... };
+			First* base = driver.data();
+			driver.each_span([&](std::span<const entity> entities, std::span<First> firsts) {
+				size_t offset = static_cast<size_t>(firsts.data() - base);
+				size_t run = 0;
+				auto flush = [&](size_t end) {
+					if (run < end) {
+						std::apply([&](auto&... pools) {
+							func(entities.subspan(run, end - run), firsts.subspan(run, end - run),
+								 std::span(pools.data() + offset + run, end - run)...);
+						}, others);
+					}
+				};
+				for (size_t k = 0; k < entities.size(); k++) {
+					entity e = entities[k];
+					bool aligned = std::apply([&](auto&... pools) {
+						return ((pools.owner(offset + k) == e) && ...);
+					}, others);
+					if (aligned) {
+						continue;
+					}
+					flush(k);
+					run = k + 1;
+					bool matches = std::apply([&](auto&... pools) {
+						return (pools.has(e) && ...);
+					}, others);
+					if (matches) {
+						std::apply([&](auto&... pools) {
+							func(entities.subspan(k, 1), firsts.subspan(k, 1), std::span(&pools.get(e), 1)...);
+						}, others);
+					}
+				}
+				flush(entities.size());
+			});
 		}
 
 		//clear all the items inside the register
 		void reset() {
 			ids.clear();
 			entity_components.clear();
+			query_plans.clear();
+			relations.clear();
+			for (auto& query : persistent_queries) {
+				query->matches.clear();
+			}
 			for (auto& pool : pools) {
-				pool.get()->clear();
+				if (pool.has_value()) {
+					pool.get()->clear();
+				}
 			}
 		}
 
@@ -258,7 +1318,9 @@ namespace myecs {
 		MYECS_NODISCARD size_t component_count()const {
 			size_t ret = {};
 			for (const auto& pool : pools) {
-				ret += pool.get()->count();
+				if (pool.has_value()) {
+					ret += pool.get()->count();
+				}
 			}
 			return ret;
 		}
@@ -266,10 +1328,37 @@ namespace myecs {
 		MYECS_NODISCARD size_t max_component_count()const {
 			size_t ret = {};
 			for (const auto& pool : pools) {
-				ret += pool.get()->max_count();
+				if (pool.has_value()) {
+					ret += pool.get()->max_count();
+				}
 			}
 			return ret;
 		}
+
+		//walks every pool, cheap enough for periodic telemetry but not for per frame use
+		MYECS_NODISCARD RegistryStats stats()const {
+			RegistryStats ret;
+			ret.entity_count = ids.count();
+			ret.max_entity_count = ids.max_count();
+			ret.entity_bytes = ids.memory_usage() + entity_components.capacity() * sizeof(SparseSet<id_type>);
+			for (const auto& components : entity_components) {
+				ret.entity_bytes += components.memory_usage();
+			}
+			for (const auto& pool : pools) {
+				if (pool.has_value()) {
+					ret.pools.push_back(pool.get()->stats());
+				}
+			}
+			return ret;
+		}
+
+		template<class T>
+		MYECS_NODISCARD PoolStats stats()const {
+			if (const ComponentPool<T>* pool = try_get_pool<T>()) {
+				return pool->stats();
+			}
+			return PoolStats{ types::type_name<T>() };
+		}
 	};
 
 }//namespace myecs
@@ -0,0 +1,236 @@
+#pragma once
+#ifndef MYECS_HIERARCHY_H
+#define MYECS_HIERARCHY_H
+
+#include<algorithm>
+#include<span>
+#include<stdexcept>
+#include<vector>
+#include"container.h"
+
+
+namespace myecs {
+
+	//parent/child relations kept in depth first order: every subtree is one contiguous run
+	//that starts with its root, so a single forward pass sees each parent before its children.
+	//reparenting rotates the moved subtree to its new place and only touches the entries in between
+	class Hierarchy {
+	public:
+		static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+	private:
+		//aligned arrays in depth first order
+		std::vector<entity> nodes;
+		std::vector<entity> parents;
+		std::vector<size_t> sizes;		//subtree size, the node included
+		//index in nodes by entity id
+		IntVector<size_t> positions;
+
+		size_t position(entity e)const {
+			return positions[e.get_id()];
+		}
+
+		void add_to_ancestors(entity parent, size_t count, bool grow) {
+			for (entity a = parent; a != null_entity; a = parents[position(a)]) {
+				size_t& size = sizes[position(a)];
+				size = grow ? size + count : size - count;
+			}
+		}
+
+		void rotate(size_t first, size_t middle, size_t last) {
+			std::rotate(nodes.begin() + first, nodes.begin() + middle, nodes.begin() + last);
+			std::rotate(parents.begin() + first, parents.begin() + middle, parents.begin() + last);
+			std::rotate(sizes.begin() + first, sizes.begin() + middle, sizes.begin() + last);
+			for (size_t i = first; i < last; i++) {
+				positions[nodes[i].get_id()] = i;
+			}
+		}
+
+	public:
+		MYECS_NODISCARD bool contains(entity e)const {
+			size_t id = e.get_id();
+			return id < positions.size() && positions[id] != npos && nodes[positions[id]] == e;
+		}
+
+		//adds e as a root without children, nothing happens if it is already a node
+		void insert(entity e) {
+			if (contains(e)) {
+				return;
+			}
+			size_t id = e.get_id();
+			while (positions.size() <= id) {
+				positions.emplace_back(npos);
+			}
+			positions[id] = nodes.size();
+			MYECS_CHECK_ALLOCATION(nodes.size() == nodes.capacity());
+			nodes.push_back(e);
+			parents.push_back(null_entity);
+			sizes.push_back(1);
+		}
+
+		//moves e with its subtree to the end of the children of parent, or to the roots for null_entity.
+		//missing nodes are inserted first
+		void set_parent(entity e, entity parent) {
+			insert(e);
+			if (parent != null_entity) {
+				insert(parent);
+			}
+			size_t p = position(e);
+			size_t count = sizes[p];
+			if (parent != null_entity && position(parent) >= p && position(parent) < p + count) {
+				throw std::runtime_error("hierarchy cycle");
+			}
+			//the end of the new parent's run, measured while the subtree still sits where it was
+			size_t target = parent == null_entity ? nodes.size() : position(parent) + sizes[position(parent)];
+			add_to_ancestors(parents[p], count, false);
+			add_to_ancestors(parent, count, true);
+			parents[p] = parent;
+			if (target > p + count) {
+				rotate(p, p + count, target);
+			}
+			else if (target < p) {
+				rotate(target, p, p + count);
+			}
+		}
+
+		//removes e, its children move up to its parent
+		void erase(entity e) {
+			if (!contains(e)) {
+				return;
+			}
+			size_t p = position(e);
+			entity parent = parents[p];
+			for (size_t i = p + 1; i < p + sizes[p]; i++) {
+				if (parents[i] == e) {
+					parents[i] = parent;
+				}
+			}
+			add_to_ancestors(parent, 1, false);
+			nodes.erase(nodes.begin() + p);
+			parents.erase(parents.begin() + p);
+			sizes.erase(sizes.begin() + p);
+			for (size_t i = p; i < nodes.size(); i++) {
+				positions[nodes[i].get_id()] = i;
+			}
+			positions[e.get_id()] = npos;
+		}
+
+		//erase() for many entities in one pass over the nodes: the children of a removed node move up to
+		//its nearest remaining ancestor. entities outside the hierarchy and duplicates are ignored
+		void erase_bulk(std::span<const entity> removed) {
+			std::vector<bool> dead(nodes.size());
+			size_t dead_count = 0;
+			for (entity e : removed) {
+				if (contains(e) && !dead[position(e)]) {
+					dead[position(e)] = true;
+					dead_count++;
+				}
+			}
+			if (dead_count == 0) {
+				return;
+			}
+			//parents come before their children, so the parent of a removed node is already resolved
+			//to a remaining node when one of its children is reached
+			for (size_t i = 0; i < nodes.size(); i++) {
+				entity parent = parents[i];
+				if (parent != null_entity && dead[position(parent)]) {
+					parents[i] = parents[position(parent)];
+				}
+			}
+			size_t next = 0;
+			for (size_t i = 0; i < nodes.size(); i++) {
+				if (dead[i]) {
+					positions[nodes[i].get_id()] = npos;
+					continue;
+				}
+				nodes[next] = nodes[i];
+				parents[next] = parents[i];
+				next++;
+			}
+			nodes.resize(next);
+			parents.resize(next);
+			sizes.assign(next, 1);
+			for (size_t i = 0; i < next; i++) {
+				positions[nodes[i].get_id()] = i;
+			}
+			//removing nodes keeps every subtree contiguous, the sizes are summed from the leaves up
+			for (size_t i = next; i-- > 0;) {
+				if (parents[i] != null_entity) {
+					sizes[position(parents[i])] += sizes[i];
+				}
+			}
+		}
+
+		//null_entity for roots and entities outside the hierarchy
+		MYECS_NODISCARD entity parent(entity e)const {
+			return contains(e) ? parents[position(e)] : null_entity;
+		}
+
+		//e followed by all its descendants, depth first
+		MYECS_NODISCARD std::span<const entity> subtree(entity e)const {
+			if (!contains(e)) {
+				return {};
+			}
+			size_t p = position(e);
+			return std::span<const entity>(nodes.data() + p, sizes[p]);
+		}
+
+		//all nodes, depth first
+		MYECS_NODISCARD std::span<const entity> order()const {
+			return std::span<const entity>(nodes.data(), nodes.size());
+		}
+
+		//index in order() of the parent of the node at index i, npos for roots
+		MYECS_NODISCARD size_t parent_index(size_t i)const {
+			return parents[i] == null_entity ? npos : position(parents[i]);
+		}
+
+		MYECS_NODISCARD size_t size()const {
+			return nodes.size();
+		}
+
+		//entities renamed to func(entity), see Registry::renumber
+		template<class Func>
+		void remap(Func&& func) {
+			positions.clear();
+			for (size_t i = 0; i < nodes.size(); i++) {
+				nodes[i] = func(nodes[i]);
+				if (parents[i] != null_entity) {
+					parents[i] = func(parents[i]);
+				}
+				size_t id = nodes[i].get_id();
+				while (positions.size() <= id) {
+					positions.emplace_back(npos);
+				}
+				positions[id] = i;
+			}
+		}
+
+		void shrink() {
+			nodes.shrink_to_fit();
+			parents.shrink_to_fit();
+			sizes.shrink_to_fit();
+			size_t used = 0;
+			for (entity e : nodes) {
+				used = std::max(used, e.get_id() + 1);
+			}
+			positions.resize(std::min(positions.size(), used));
+			positions.shrink();
+		}
+
+		void clear() {
+			nodes.clear();
+			parents.clear();
+			sizes.clear();
+			positions.clear();
+		}
+
+		MYECS_NODISCARD size_t memory_usage()const {
+			return nodes.capacity() * sizeof(entity) + parents.capacity() * sizeof(entity) +
+				sizes.capacity() * sizeof(size_t) + positions.memory_usage();
+		}
+	};
+
+}//namespace myecs
+
+#endif
@@ -0,0 +1,173 @@
+#pragma once
+#ifndef MYECS_INDEX_H
+#define MYECS_INDEX_H
+
+#include<limits>
+#include<map>
+#include<optional>
+#include<span>
+#include<vector>
+#include"dense_map.h"
+#include"soa.h"
+
+
+namespace myecs {
+
+	template<auto Member>
+	using indexed_component_t = typename internal::member_traits<decltype(Member)>::class_type;
+
+	template<auto Member>
+	using indexed_key_t = std::remove_cv_t<typename internal::member_traits<decltype(Member)>::field_type>;
+
+	//secondary index over the components of one pool, kept up to date by ComponentPool<T>
+	//on create, destroy and patch. every index keeps the key it filed an entity under, so erase()
+	//works after the field was changed through get(); lookups see such a change only after patch()
+	template<class T>
+	class IComponentIndex {
+	public:
+		virtual ~IComponentIndex() = default;
+
+		virtual void insert(entity e, const T& value) = 0;
+		//nothing happens for entities that are not indexed
+		virtual void erase(entity e) = 0;
+		virtual void clear() = 0;
+	};
+
+	//equality lookups on T::*Member, O(1) on average
+	template<auto Member>
+	class HashIndex :public IComponentIndex<indexed_component_t<Member>> {
+	public:
+		using component_type = indexed_component_t<Member>;
+		using key_type = indexed_key_t<Member>;
+
+	private:
+		static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+		DenseMap<key_type, IntVector<entity>> buckets;
+		//position of every indexed entity in its bucket and the key of that bucket, by entity id.
+		//keys are only held while the entity is indexed
+		IntVector<size_t> positions;
+		std::vector<std::optional<key_type>> keys;
+
+	public:
+		void insert(entity e, const component_type& value)override {
+			size_t id = e.get_id();
+			while (positions.size() <= id) {
+				positions.emplace_back(npos);
+			}
+			if (keys.size() <= id) {
+				keys.resize(id + 1);
+			}
+			IntVector<entity>& list = buckets[value.*Member];
+			positions[id] = list.size();
+			keys[id].emplace(value.*Member);
+			list.emplace_back(e);
+		}
+
+		void erase(entity e)override {
+			size_t id = e.get_id();
+			if (id >= positions.size() || positions[id] == npos) {
+				return;
+			}
+			auto it = buckets.find(*keys[id]);
+			MYECS_ASSERT(it != buckets.end(), "hash index lost a bucket");
+			IntVector<entity>& list = it->second;
+			size_t i = positions[id];
+			list[i] = list.back();
+			positions[list[i].get_id()] = i;
+			list.pop_back();
+			positions[id] = npos;
+			if (list.size() == 0) {
+				buckets.erase(*keys[id]);
+			}
+			keys[id].reset();
+		}
+
+		void clear()override {
+			buckets.clear();
+			positions.clear();
+			keys.clear();
+		}
+
+		//entities whose field equals key, in no particular order
+		//the span stays valid until the index changes
+		MYECS_NODISCARD std::span<const entity> find(const key_type& key)const {
+			auto it = buckets.find(key);
+			if (it == buckets.end()) {
+				return {};
+			}
+			return std::span<const entity>(it->second.begin(), it->second.size());
+		}
+
+		MYECS_NODISCARD size_t count(const key_type& key)const {
+			return find(key).size();
+		}
+
+		//number of distinct keys
+		MYECS_NODISCARD size_t key_count()const {
+			return buckets.size();
+		}
+	};
+
+	//range lookups on T::*Member, O(log n + matches)
+	template<auto Member>
+	class OrderedIndex :public IComponentIndex<indexed_component_t<Member>> {
+	public:
+		using component_type = indexed_component_t<Member>;
+		using key_type = indexed_key_t<Member>;
+
+	private:
+		using entries_t = std::multimap<key_type, entity>;
+
+		entries_t entries;
+		//entry of every indexed entity by entity id, entries.end() for the others
+		std::vector<typename entries_t::iterator> handles;
+
+	public:
+		void insert(entity e, const component_type& value)override {
+			size_t id = e.get_id();
+			if (handles.size() <= id) {
+				handles.resize(id + 1, entries.end());
+			}
+			handles[id] = entries.emplace(value.*Member, e);
+		}
+
+		void erase(entity e)override {
+			size_t id = e.get_id();
+			if (id >= handles.size() || handles[id] == entries.end()) {
+				return;
+			}
+			entries.erase(handles[id]);
+			handles[id] = entries.end();
+		}
+
+		void clear()override {
+			entries.clear();
+			handles.clear();
+		}
+
+		//calls func(key, entity) for every key in [low, high], in key order
+		template<class Func>
+		void each(const key_type& low, const key_type& high, Func&& func)const {
+			for (auto it = entries.lower_bound(low); it != entries.end() && !(high < it->first); ++it) {
+				func(it->first, it->second);
+			}
+		}
+
+		//entities with keys in [low, high], in key order
+		MYECS_NODISCARD IntVector<entity> find(const key_type& low, const key_type& high)const {
+			IntVector<entity> ret;
+			each(low, high, [&](const key_type&, entity e) {
+				ret.emplace_back(e);
+			});
+			return ret;
+		}
+
+		MYECS_NODISCARD size_t size()const {
+			return entries.size();
+		}
+	};
+
+}//namespace myecs
+
+#endif
@@ -0,0 +1,574 @@
+#pragma once
+#ifndef MYECS_MAPPED_REGISTRY_H
+#define MYECS_MAPPED_REGISTRY_H
+
+#include<cstring>
+#include<filesystem>
+#include<span>
+#include<stdexcept>
+#include<tuple>
+#include"types.h"
+#include"utils.h"
+#include"profile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include<windows.h>
+#else
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<unistd.h>
+#endif
+
+
+namespace myecs {
+
+	namespace internal {
+		//a file mapped read/write into memory, resize() maps it again
+		class MappedFile {
+		private:
+			std::byte* base = nullptr;
+			size_t m_size = 0;
+#ifdef _WIN32
+			HANDLE file = INVALID_HANDLE_VALUE;
+			HANDLE mapping = nullptr;
+#else
+			int fd = -1;
+#endif
+
+			void map() {
+				if (!m_size) {
+					return;
+				}
+#ifdef _WIN32
+				LARGE_INTEGER size;
+				size.QuadPart = static_cast<LONGLONG>(m_size);
+				mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, size.HighPart, size.LowPart, nullptr);
+				void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, m_size) : nullptr;
+				if (!view) {
+					throw std::runtime_error("can not map file");
+				}
+#else
+				void* view = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+				if (view == MAP_FAILED) {
+					throw std::runtime_error("can not map file");
+				}
+#endif
+				base = static_cast<std::byte*>(view);
+			}
+
+			void unmap() {
+#ifdef _WIN32
+				if (base) {
+					UnmapViewOfFile(base);
+				}
+				if (mapping) {
+					CloseHandle(mapping);
+					mapping = nullptr;
+				}
+#else
+				if (base) {
+					munmap(base, m_size);
+				}
+#endif
+				base = nullptr;
+			}
+
+		public:
+			//opens path or creates an empty file there, the current contents are mapped
+			explicit MappedFile(const std::filesystem::path& path) {
+#ifdef _WIN32
+				file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+								   OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+				LARGE_INTEGER size;
+				if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size)) {
+					throw std::runtime_error("can not open file");
+				}
+				m_size = static_cast<size_t>(size.QuadPart);
+#else
+				fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+				struct stat info;
+				if (fd < 0 || fstat(fd, &info) != 0) {
+					throw std::runtime_error("can not open file");
+				}
+				m_size = static_cast<size_t>(info.st_size);
+#endif
+				map();
+			}
+
+			MappedFile(MappedFile&& other)noexcept :
+				base(other.base),
+				m_size(other.m_size)
+#ifdef _WIN32
+				, file(other.file), mapping(other.mapping) {
+				other.file = INVALID_HANDLE_VALUE;
+				other.mapping = nullptr;
+#else
+				, fd(other.fd) {
+				other.fd = -1;
+#endif
+				other.base = nullptr;
+				other.m_size = 0;
+			}
+
+			MappedFile(const MappedFile&) = delete;
+
+			~MappedFile() {
+				unmap();
+#ifdef _WIN32
+				if (file != INVALID_HANDLE_VALUE) {
+					CloseHandle(file);
+				}
+#else
+				if (fd >= 0) {
+					::close(fd);
+				}
+#endif
+			}
+
+			//sets the file length and maps it again, the mapping may move
+			void resize(size_t size) {
+				unmap();
+#ifdef _WIN32
+				LARGE_INTEGER length;
+				length.QuadPart = static_cast<LONGLONG>(size);
+				if (!SetFilePointerEx(file, length, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+					throw std::runtime_error("can not resize file");
+				}
+#else
+				if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+					throw std::runtime_error("can not resize file");
+				}
+#endif
+				m_size = size;
+				map();
+			}
+
+			//writes the dirty pages back, wait = false only schedules the write
+			void flush(bool wait) {
+				if (!base) {
+					return;
+				}
+#ifdef _WIN32
+				if (!FlushViewOfFile(base, 0) || (wait && !FlushFileBuffers(file))) {
+					throw std::runtime_error("can not flush file");
+				}
+#else
+				if (msync(base, m_size, wait ? MS_SYNC : MS_ASYNC) != 0) {
+					throw std::runtime_error("can not flush file");
+				}
+#endif
+			}
+
+			std::byte* data()const {
+				return base;
+			}
+
+			size_t size()const {
+				return m_size;
+			}
+		};
+	}//namespace internal
+
+	//a registry for trivially copyable components that lives in a memory mapped file: the entity id state,
+	//a sparse set per component and the component values. opening a world maps the file and checks the
+	//header, pages are read in as they are touched. same api shape as StaticRegistry.
+	//the file keeps the native byte order and layout, renaming or changing a component type rejects it
+	template<class ...Components>
+	class MappedRegistry {
+	public:
+		static constexpr size_t component_count_v = sizeof...(Components);
+		static constexpr types::u64 magic = 0x50414d534345594dull;	//"MYECSMAP" in memory order
+		static constexpr types::u32 format_version = 1;
+
+		template<class T>
+		static constexpr size_t index_of = [] {
+			constexpr bool same[] = { std::is_same_v<T, Components>... };
+			for (size_t i = 0; i < component_count_v; i++) {
+				if (same[i]) {
+					return i;
+				}
+			}
+			return component_count_v;
+		}();
+
+		template<class T>
+		static constexpr bool contains_v = index_of<T> < component_count_v;
+
+		//type names, sizes and alignments of the components and the entity handle layout
+		static constexpr types::u64 layout_hash = [] {
+			types::u64 hash = 0xCBF29CE484222325;
+			auto mix = [&](types::u64 value) {
+				hash ^= value;
+				hash *= 0x100000001B3;
+			};
+			mix(sizeof(entity));
+			mix(entity::traits_type::id_bits);
+			mix(entity::traits_type::version_bits);
+			(mix(types::type_hash<Components>()), ...);
+			(mix(sizeof(Components)), ...);
+			(mix(alignof(Components)), ...);
+			return hash;
+		}();
+
+	private:
+		static_assert(sizeof...(Components) > 0, "mapped registry needs at least one component");
+		static_assert((std::is_trivially_copyable_v<Components> && ...), "mapped components must be trivially copyable");
+
+		using u32 = types::u32;
+		using u64 = types::u64;
+
+		static constexpr u64 null_index = ~u64(0);
+		static constexpr size_t section_alignment = 64;
+		static constexpr size_t min_capacity = 64;
+		static constexpr size_t value_sizes[] = { sizeof(Components)... };
+
+		struct Header {
+			u64 magic;
+			u32 format_version;
+			u32 component_types;
+			u64 layout_hash;
+			u64 capacity;
+			u64 entity_count;
+			u64 max_entity;		//ids handed out so far, live or free
+			u64 free_count;
+			u64 sizes[component_count_v];
+		};
+
+		struct Node {
+			u32 valid;
+			u32 version;
+		};
+
+		//byte offsets of the arrays for a capacity, every array holds capacity entries
+		struct Layout {
+			size_t nodes = 0;
+			size_t free = 0;
+			size_t sparse[component_count_v] = {};
+			size_t dense[component_count_v] = {};
+			size_t values[component_count_v] = {};
+			size_t size = 0;
+		};
+
+		internal::MappedFile file;
+		Layout sections;
+
+		static Layout layout_for(size_t capacity) {
+			Layout ret;
+			size_t offset = sizeof(Header);
+			auto place = [&](size_t alignment, size_t bytes) {
+				offset = (offset + alignment - 1) / alignment * alignment;
+				size_t begin = offset;
+				offset += bytes;
+				return begin;
+			};
+			ret.nodes = place(section_alignment, capacity * sizeof(Node));
+			ret.free = place(section_alignment, capacity * sizeof(u64));
+			size_t k = 0;
+			((ret.sparse[k] = place(section_alignment, capacity * sizeof(u64)),
+			  ret.dense[k] = place(section_alignment, capacity * sizeof(entity)),
+			  ret.values[k] = place(alignof(Components) > section_alignment ? alignof(Components) : section_alignment, capacity * sizeof(Components)),
+			  k++), ...);
+			ret.size = place(section_alignment, 0);
+			return ret;
+		}
+
+		template<class P>
+		P* at(size_t offset)const {
+			return reinterpret_cast<P*>(file.data() + offset);
+		}
+
+		Header& header()const {
+			return *at<Header>(0);
+		}
+
+		Node* nodes()const {
+			return at<Node>(sections.nodes);
+		}
+
+		u64* free_ids()const {
+			return at<u64>(sections.free);
+		}
+
+		template<class T>
+		u64* sparse_array()const {
+			return at<u64>(sections.sparse[index_of<T>]);
+		}
+
+		template<class T>
+		entity* dense_array()const {
+			return at<entity>(sections.dense[index_of<T>]);
+		}
+
+		template<class T>
+		T* value_array()const {
+			return at<T>(sections.values[index_of<T>]);
+		}
+
+		//the arrays only move towards the end of the file, so they are moved last one first
+		void grow(size_t capacity) {
+			MYECS_PROFILE_SCOPE("MappedRegistry::grow");
+			size_t old_capacity = header().capacity;
+			Layout old = sections;
+			Layout next = layout_for(capacity);
+			file.resize(next.size);
+			sections = next;
+			for (size_t k = component_count_v; k-- > 0;) {
+				std::memmove(at<std::byte>(next.values[k]), at<std::byte>(old.values[k]), old_capacity * value_sizes[k]);
+				std::memmove(at<std::byte>(next.dense[k]), at<std::byte>(old.dense[k]), old_capacity * sizeof(entity));
+				std::memmove(at<std::byte>(next.sparse[k]), at<std::byte>(old.sparse[k]), old_capacity * sizeof(u64));
+				std::memset(at<std::byte>(next.sparse[k]) + old_capacity * sizeof(u64), 0xFF, (capacity - old_capacity) * sizeof(u64));
+			}
+			std::memmove(at<std::byte>(next.free), at<std::byte>(old.free), old_capacity * sizeof(u64));
+			std::memset(nodes() + old_capacity, 0, (capacity - old_capacity) * sizeof(Node));
+			header().capacity = capacity;
+		}
+
+		template<class T>
+		void erase(entity e) {
+			u64* index = sparse_array<T>();
+			u64 i = index[e.get_id()];
+			u64& size = header().sizes[index_of<T>];
+			entity last = dense_array<T>()[size - 1];
+			dense_array<T>()[i] = last;
+			value_array<T>()[i] = value_array<T>()[size - 1];
+			index[last.get_id()] = i;
+			index[e.get_id()] = null_index;
+			size--;
+		}
+
+		template<class T>
+		bool has_one(entity e)const {
+			if (!valid(e)) {
+				return false;
+			}
+			u64 i = sparse_array<T>()[e.get_id()];
+			return i != null_index && dense_array<T>()[i] == e;
+		}
+
+		template<class First, class ...Types>
+		static constexpr size_t smallest_index(const Header& h) {
+			size_t ret = index_of<First>;
+			((ret = h.sizes[index_of<Types>] < h.sizes[ret] ? index_of<Types> : ret), ...);
+			return ret;
+		}
+
+	public:
+		//opens the world stored at path, or creates an empty one with room for capacity entities.
+		//throws if the file was written by another format version or another component list
+		explicit MappedRegistry(const std::filesystem::path& path, size_t capacity = min_capacity) :file(path) {
+			if (file.size() == 0) {
+				capacity = capacity < min_capacity ? min_capacity : capacity;
+				sections = layout_for(capacity);
+				file.resize(sections.size);
+				Header& h = header();
+				h = Header{ magic, format_version, static_cast<u32>(component_count_v), layout_hash, capacity, 0, 0, 0, {} };
+				for (size_t k = 0; k < component_count_v; k++) {
+					std::memset(at<std::byte>(sections.sparse[k]), 0xFF, capacity * sizeof(u64));
+				}
+				return;
+			}
+			if (file.size() < sizeof(Header) || header().magic != magic) {
+				throw std::runtime_error("not a mapped registry file");
+			}
+			const Header& h = header();
+			if (h.format_version != format_version) {
+				throw std::runtime_error("unsupported mapped registry format version");
+			}
+			if (h.component_types != component_count_v || h.layout_hash != layout_hash) {
+				throw std::runtime_error("mapped registry layout checksum mismatch");
+			}
+			sections = layout_for(h.capacity);
+			if (file.size() < sections.size) {
+				throw std::runtime_error("mapped registry file is truncated");
+			}
+			bool sizes_fit = true;
+			for (size_t k = 0; k < component_count_v; k++) {
+				sizes_fit = sizes_fit && h.sizes[k] <= h.entity_count;
+			}
+			if (h.max_entity > h.capacity || h.entity_count > h.max_entity ||
+				h.free_count != h.max_entity - h.entity_count || !sizes_fit) {
+				throw std::runtime_error("corrupt mapped registry header");
+			}
+		}
+
+		MappedRegistry(MappedRegistry&&) noexcept = default;
+		MappedRegistry(const MappedRegistry&) = delete;
+
+		MYECS_NODISCARD entity create() {
+			Header& h = header();
+			size_t id;
+			if (h.free_count) {
+				id = static_cast<size_t>(free_ids()[--h.free_count]);
+			}
+			else {
+				if (h.max_entity > entity::traits_type::max_id) {
+					throw std::runtime_error("out of entity ids");
+				}
+				if (h.max_entity == h.capacity) {
+					grow(static_cast<size_t>(h.capacity) * 2);
+				}
+				id = static_cast<size_t>(header().max_entity++);
+			}
+			header().entity_count++;
+			Node& node = nodes()[id];
+			node.valid = 1;
+			return entity(id, node.version);
+		}
+
+		//room for count entities without growing the file
+		void reserve(size_t count) {
+			if (count > header().capacity) {
+				grow(count);
+			}
+		}
+
+		void destroy(entity e) {
+			if (!valid(e)) {
+				return;
+			}
+			((has_one<Components>(e) ? erase<Components>(e) : void(0)), ...);
+			size_t id = e.get_id();
+			Node& node = nodes()[id];
+			node.version = static_cast<u32>((node.version + 1) & entity::traits_type::version_mask);
+			node.valid = 0;
+			Header& h = header();
+			free_ids()[h.free_count++] = id;
+			h.entity_count--;
+		}
+
+		template<class ...Types>
+			requires (sizeof...(Types) >= 1 && (contains_v<Types> && ...))
+		void destroy(entity e) {
+			((has_one<Types>(e) ? erase<Types>(e) : void(0)), ...);
+		}
+
+		MYECS_NODISCARD bool valid(entity e)const {
+			size_t id = e.get_id();
+			const Node* node = nodes();
+			return id < header().max_entity && node[id].valid && node[id].version == e.get_version();
+		}
+
+		//the reference expires when the file grows, like references into pools
+		template<class T, class ...Args>
+			requires contains_v<T>
+		T& emplace(entity e, Args&&... args) {
+			if constexpr (myecs_debug_level) {
+				if (!valid(e)) {
+					throw std::runtime_error("invalid entity");
+				}
+			}
+			if (has_one<T>(e)) {
+				throw std::runtime_error("entity already has component");
+			}
+			u64& size = header().sizes[index_of<T>];
+			size_t i = static_cast<size_t>(size++);
+			dense_array<T>()[i] = e;
+			sparse_array<T>()[e.get_id()] = i;
+			return *new (&value_array<T>()[i]) T(std::forward<Args>(args)...);
+		}
+
+		template<class ...Types>
+			requires (sizeof...(Types) >= 1 && (contains_v<Types> && ...))
+		MYECS_NODISCARD bool has(entity e)const {
+			return (has_one<Types>(e) && ...);
+		}
+
+		template<class T>
+			requires contains_v<T>
+		MYECS_NODISCARD T& get(entity e) {
+			if constexpr (myecs_debug_level) {
+				if (!has_one<T>(e)) {
+					throw std::runtime_error("invalid entity");
+				}
+			}
+			return value_array<T>()[sparse_array<T>()[e.get_id()]];
+		}
+
+		template<class ...Types>
+			requires (sizeof...(Types) >= 2)
+		MYECS_NODISCARD std::tuple<Types&...> get(entity e) {
+			return std::tuple<Types&...>(get<Types>(e)...);
+		}
+
+		template<class T>
+			requires contains_v<T>
+		MYECS_NODISCARD T* try_get(entity e) {
+			return has_one<T>(e) ? &value_array<T>()[sparse_array<T>()[e.get_id()]] : nullptr;
+		}
+
+		//owners of T, aligned with value_array<T>()
+		template<class T>
+			requires contains_v<T>
+		MYECS_NODISCARD std::span<const entity> view()const {
+			return std::span<const entity>(dense_array<T>(), static_cast<size_t>(header().sizes[index_of<T>]));
+		}
+
+		template<class T>
+			requires contains_v<T>
+		MYECS_NODISCARD std::span<T> values() {
+			return std::span<T>(value_array<T>(), static_cast<size_t>(header().sizes[index_of<T>]));
+		}
+
+		//calls func(entity, components...) for every entity owning all Types, driven by the smallest set
+		template<class ...Types, class Func>
+			requires (sizeof...(Types) >= 1 && (contains_v<Types> && ...))
+		void each(Func&& func) {
+			const entity* driver = nullptr;
+			size_t size = 0;
+			size_t k = smallest_index<Types...>(header());
+			((index_of<Types> == k ? (driver = dense_array<Types>(), size = static_cast<size_t>(header().sizes[k])) : 0), ...);
+			for (size_t i = 0; i < size; i++) {
+				entity e = driver[i];
+				if (((index_of<Types> == k || has_one<Types>(e)) && ...)) {
+					func(e, get<Types>(e)...);
+				}
+			}
+		}
+
+		//writes the mapped pages back to the file, wait = false only schedules the write
+		void flush(bool wait = true) {
+			MYECS_PROFILE_SCOPE("MappedRegistry::flush");
+			file.flush(wait);
+		}
+
+		//forgets every entity, the file keeps its size
+		void reset() {
+			Header& h = header();
+			for (size_t k = 0; k < component_count_v; k++) {
+				std::memset(at<std::byte>(sections.sparse[k]), 0xFF, static_cast<size_t>(h.max_entity) * sizeof(u64));
+				h.sizes[k] = 0;
+			}
+			std::memset(nodes(), 0, static_cast<size_t>(h.max_entity) * sizeof(Node));
+			h.entity_count = h.max_entity = h.free_count = 0;
+		}
+
+		MYECS_NODISCARD size_t entity_count()const {
+			return static_cast<size_t>(header().entity_count);
+		}
+
+		MYECS_NODISCARD size_t max_entity_count()const {
+			return static_cast<size_t>(header().max_entity);
+		}
+
+		template<class T>
+			requires contains_v<T>
+		MYECS_NODISCARD size_t size()const {
+			return static_cast<size_t>(header().sizes[index_of<T>]);
+		}
+
+		MYECS_NODISCARD size_t capacity()const {
+			return static_cast<size_t>(header().capacity);
+		}
+
+		MYECS_NODISCARD size_t file_size()const {
+			return file.size();
+		}
+	};
+
+}//namespace myecs
+
+#endif
@@ -1,15 +1,73 @@
 #pragma once
+#include<algorithm>
+#include<cstddef>
+#include<cstring>
 #include<unordered_map>
 #include<stdexcept>
-#include<optional>
-#include"types.h"
+#include<memory>
+#include<new>
+#include<span>
+#include<string>
+#include<tuple>
+#include<vector>
+#include"container.h"
+#include"profile.h"
 
 
 namespace myecs {
 
+	//how a pool picks its next capacity once it is full
+	struct GrowthPolicy {
+		enum class Kind {
+			geometric,	//doubles, at least 8 slots
+			linear,		//whole pages of step slots
+			fixed		//step slots allocated at once, growing past them throws
+		};
+
+		Kind kind = Kind::geometric;
+		size_t step = 0;
+
+		MYECS_NODISCARD static constexpr GrowthPolicy geometric() {
+			return {};
+		}
+
+		MYECS_NODISCARD static constexpr GrowthPolicy linear(size_t page) {
+			return { Kind::linear, std::max<size_t>(page, 1) };
+		}
+
+		MYECS_NODISCARD static constexpr GrowthPolicy fixed(size_t capacity) {
+			return { Kind::fixed, capacity };
+		}
+
+		//capacity for at least required slots, coming from capacity
+		MYECS_NODISCARD size_t next_capacity(size_t capacity, size_t required)const {
+			switch (kind) {
+			case Kind::linear:
+				return (required + step - 1) / step * step;
+			case Kind::fixed:
+				if (required > step) {
+					throw std::runtime_error("pool capacity exceeded");
+				}
+				return step;
+			default:
+				return std::max({ size_t(8), capacity * 2, required });
+			}
+		}
+
+		//capacity for an explicit reserve of required slots
+		MYECS_NODISCARD size_t reserve_capacity(size_t required)const {
+			if (kind == Kind::fixed && required > step) {
+				throw std::runtime_error("pool capacity exceeded");
+			}
+			return required;
+		}
+	};
+
 	namespace pool {
+#ifdef _MSC_VER
 	#pragma warning(push)
 	#pragma warning(disable:26495)
+#endif
 		template<class Base, size_t Size>
 		class ClassData {
 		private:
@@ -57,6 +115,7 @@ namespace myecs {
 			template<class T, class ...Args>
 				requires std::derived_from<T, Base>
 			void emplace(Args&&... args) {
+				static_assert(sizeof(T) <= Size && alignof(T) <= alignof(std::max_align_t), "type does not fit the buffer");
 				destroy();
 				new (data) T(std::forward<Args>(args)...);
 				move_construct = [](void* self_data, void* other_data) {
@@ -68,7 +127,9 @@ namespace myecs {
 				return (bool)(move_construct);
 			}
 		};
+#ifdef _MSC_VER
 	#pragma warning(pop)
+#endif
 
 		class IPool {
 		public:
@@ -77,35 +138,110 @@ namespace myecs {
 			virtual size_t max_count()const = 0;
 		};
 
+		//objects live in one contiguous array of T, indexed by the id handed out by create()
+		//destroyed slots are reused first, so the array stays dense unless the pool shrinks a lot
 		template<class T>
 		class Pool :public IPool {
 		private:
-			std::vector<std::optional<T>> storage;
+			struct alignas(T) Slot {
+				unsigned char bytes[sizeof(T)];
+			};
+
+			std::unique_ptr<Slot[]> storage;
+			size_t m_capacity = 0;
 			IdGen<size_t> ids;
+			GrowthPolicy growth;
+
+			T* slot(size_t id) {
+				return std::launder(reinterpret_cast<T*>(&storage[id]));
+			}
+
+			const T* slot(size_t id)const {
+				return std::launder(reinterpret_cast<const T*>(&storage[id]));
+			}
+
+			void reallocate(size_t new_capacity) {
+				MYECS_PROFILE_SCOPE("Pool::grow");
+				MYECS_PROFILE_COUNT(reallocation, 1);
+				MYECS_PROFILE_COUNT(bytes_moved, ids.count() * sizeof(T));
+				MYECS_CHECK_ALLOCATION(true);
+				std::unique_ptr<Slot[]> new_storage(new Slot[new_capacity]);
+				for (size_t i = 0; i < ids.max_count(); i++) {
+					if (ids.active(i)) {
+						new (&new_storage[i]) T(std::move(*slot(i)));
+						slot(i)->~T();
+					}
+				}
+				storage = std::move(new_storage);
+				m_capacity = new_capacity;
+			}
+
+			void grow() {
+				if (ids.max_count() == m_capacity) {
+					reallocate(growth.next_capacity(m_capacity, m_capacity + 1));
+				}
+			}
+
+			void destroy_all() {
+				if constexpr (!std::is_trivially_destructible_v<T>) {
+					for (size_t i = 0; i < ids.max_count(); i++) {
+						if (ids.active(i)) {
+							slot(i)->~T();
+						}
+					}
+				}
+			}
 
 		public:
 			Pool() {}
 			Pool(Pool&& other)noexcept :
 				storage(std::move(other.storage)),
-				ids(std::move(other.ids)) {
+				m_capacity(other.m_capacity),
+				ids(std::move(other.ids)),
+				growth(other.growth) {
+				other.m_capacity = 0;
+			}
+			~Pool() {
+				destroy_all();
 			}
 
 			template<class ...Args>
 			size_t create(Args&&... args) {
 				if (ids.full()) {
-					storage.emplace_back();
+					grow();
 				}
 				size_t id = ids.get();
-				storage[id].emplace(std::forward<Args>(args)...);
+				new (&storage[id]) T(std::forward<Args>(args)...);
 				return id;
 			}
 
+			//count copies of value, their ids go to out. free slots are reused first, the rest lands in
+			//consecutive new slots that are filled in one pass (a plain copy for trivially copyable T)
+			void create_bulk(size_t count, const T& value, size_t* out) {
+				size_t reused = std::min(count, ids.free_count());
+				for (size_t i = 0; i < reused; i++) {
+					out[i] = create(value);
+				}
+				size_t rest = count - reused;
+				if (rest == 0) {
+					return;
+				}
+				size_t first = ids.max_count();
+				if (first + rest > m_capacity) {
+					reallocate(growth.next_capacity(m_capacity, first + rest));
+				}
+				for (size_t i = 0; i < rest; i++) {
+					out[reused + i] = ids.get();
+				}
+				std::uninitialized_fill_n(reinterpret_cast<T*>(&storage[first]), rest, value);
+			}
+
 			bool valid(size_t id)const {
 				return ids.active(id);
 			}
 
 			T& get(size_t id) {
-				return storage[id].value();
+				return *slot(id);
 			}
 
 			T* try_get(size_t id) {
@@ -115,8 +251,27 @@ namespace myecs {
 				return nullptr;
 			}
 
+			//slots [0, max_count()), only valid() ones hold an object
+			T* data() {
+				return storage ? slot(0) : nullptr;
+			}
+
+			void prefetch(size_t id)const {
+				if (id < m_capacity) {
+					MYECS_PREFETCH(&storage[id]);
+				}
+			}
+
+			//slots [begin, begin + count), all of them must be valid
+			std::tuple<std::span<T>> spans(size_t begin, size_t count) {
+				return { std::span<T>(data() + begin, count) };
+			}
+
 			void destroy(size_t id) {
-				storage[id].reset();
+				if (!valid(id)) {
+					return;
+				}
+				slot(id)->~T();
 				ids.ret(id);
 			}
 
@@ -128,76 +283,443 @@ namespace myecs {
 				return ids.max_count();
 			}
 
+			//slots left behind by destroyed objects, reused before storage grows
+			size_t free_count()const {
+				return ids.free_count();
+			}
+
+			size_t capacity()const {
+				return m_capacity;
+			}
+
+			//room for count objects without allocation
+			void reserve(size_t count) {
+				if (count > m_capacity) {
+					reallocate(growth.reserve_capacity(count));
+				}
+				ids.reserve(count);
+			}
+
+			//moves the objects at or above slot count() into the free slots below it, calling moved(from, to)
+			//for each, then shrinks the storage to count() slots
+			template<class Func>
+			void compact(Func&& moved) {
+				MYECS_PROFILE_SCOPE("Pool::compact");
+				size_t live = ids.count();
+				size_t hole = 0;
+				for (size_t from = live; from < ids.max_count(); from++) {
+					if (!ids.active(from)) {
+						continue;
+					}
+					while (ids.active(hole)) {
+						hole++;
+					}
+					new (&storage[hole]) T(std::move(*slot(from)));
+					slot(from)->~T();
+					moved(from, hole);
+					hole++;
+				}
+				ids.assign(live);
+				if (live == 0) {
+					storage.reset();
+					m_capacity = 0;
+				}
+				else if (m_capacity > live) {
+					reallocate(live);
+				}
+			}
+
+			void set_growth(GrowthPolicy policy) {
+				growth = policy;
+			}
+
+			MYECS_NODISCARD GrowthPolicy growth_policy()const {
+				return growth;
+			}
+
+			size_t memory_usage()const {
+				return m_capacity * sizeof(Slot) + ids.memory_usage();
+			}
+
+			//keeps the storage for reuse
 			void clear() {
-				storage.clear();
+				destroy_all();
 				ids.clear();
 			}
 		};
 
-		//testing...
-		class ComponentMgr {
-		private:
-			using PoolData = ClassData<IPool, sizeof(Pool<int>)>;
-			std::unordered_map<size_t, PoolData> pools;
+		//layout and lifetime of a component type that only exists at runtime, e.g. one defined by a script.
+		//null construct zero fills, null move_construct relocates with memcpy, null destroy does nothing
+		struct TypeInfo {
+			std::string name;
+			size_t size = 0;
+			size_t alignment = 1;
+			void (*construct)(void* self_data) = nullptr;
+			void (*move_construct)(void* self_data, void* other_data) = nullptr;
+			void (*destroy)(void* self_data) = nullptr;
+
+			//distance between two slots
+			MYECS_NODISCARD size_t stride()const {
+				return std::max<size_t>((size + alignment - 1) / alignment * alignment, alignment);
+			}
 
+			//the description of a C++ type, types without a default constructor must be created from a value
 			template<class T>
-			Pool<T>* get_pool() {
-				PoolData& data = pools[types::type_hash<T>()];
-				if (!data.has_value()) {
-					data.emplace<Pool<T>>();
+			MYECS_NODISCARD static TypeInfo of() {
+				TypeInfo ret;
+				ret.name = types::type_name<T>();
+				ret.size = sizeof(T);
+				ret.alignment = alignof(T);
+				if constexpr (std::is_default_constructible_v<T> && !std::is_trivially_default_constructible_v<T>) {
+					ret.construct = [](void* self_data) {
+						new (self_data) T();
+					};
+				}
+				if constexpr (!std::is_trivially_copyable_v<T>) {
+					ret.move_construct = [](void* self_data, void* other_data) {
+						new (self_data) T(std::move(*reinterpret_cast<T*>(other_data)));
+					};
+				}
+				if constexpr (!std::is_trivially_destructible_v<T>) {
+					ret.destroy = [](void* self_data) {
+						reinterpret_cast<T*>(self_data)->~T();
+					};
 				}
-				return data.get<Pool<T>>();
+				return ret;
 			}
+		};
 
-			template<class T>
-			Pool<T>* try_get_pool() {
-				if (auto it = pools.find(types::type_hash<T>()); it != pools.end()) {
-					return it->second.get<Pool<T>>();
+		//Pool for a type described by a TypeInfo: slots of info.stride() bytes in one aligned block,
+		//ids handed out like Pool<T>
+		class RawPool :public IPool {
+		private:
+			std::shared_ptr<const TypeInfo> info;
+			std::byte* storage = nullptr;
+			size_t m_capacity = 0;
+			IdGen<size_t> ids;
+			GrowthPolicy growth;
+
+			void deallocate() {
+				if (storage) {
+					::operator delete(storage, std::align_val_t(info->alignment));
+					storage = nullptr;
 				}
-				return nullptr;
 			}
 
-			template<class T>
-			const Pool<T>* try_get_pool()const {
-				if (auto it = pools.find(types::type_hash<T>()); it != pools.end()) {
-					return it->second.get<Pool<T>>();
+			void reallocate(size_t new_capacity) {
+				MYECS_PROFILE_SCOPE("RawPool::grow");
+				MYECS_PROFILE_COUNT(reallocation, 1);
+				MYECS_PROFILE_COUNT(bytes_moved, ids.count() * info->size);
+				MYECS_CHECK_ALLOCATION(true);
+				size_t stride = info->stride();
+				std::byte* new_storage = static_cast<std::byte*>(::operator new(new_capacity * stride, std::align_val_t(info->alignment)));
+				if (!info->move_construct) {
+					if (storage) {
+						std::memcpy(new_storage, storage, ids.max_count() * stride);
+					}
+				}
+				else {
+					for (size_t i = 0; i < ids.max_count(); i++) {
+						if (ids.active(i)) {
+							info->move_construct(new_storage + i * stride, get(i));
+							if (info->destroy) {
+								info->destroy(get(i));
+							}
+						}
+					}
+				}
+				deallocate();
+				storage = new_storage;
+				m_capacity = new_capacity;
+			}
+
+			void destroy_all() {
+				if (info && info->destroy) {
+					for (size_t i = 0; i < ids.max_count(); i++) {
+						if (ids.active(i)) {
+							info->destroy(get(i));
+						}
+					}
+				}
+			}
+
+		public:
+			explicit RawPool(std::shared_ptr<const TypeInfo> info) :info(std::move(info)) {
+				if constexpr (myecs_debug_level) {
+					const size_t alignment = this->info->alignment;
+					if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+						throw std::runtime_error("alignment must be a power of two");
+					}
+				}
+			}
+			RawPool(RawPool&& other)noexcept :
+				info(std::move(other.info)),
+				storage(other.storage),
+				m_capacity(other.m_capacity),
+				ids(std::move(other.ids)),
+				growth(other.growth) {
+				other.storage = nullptr;
+				other.m_capacity = 0;
+			}
+			~RawPool() {
+				destroy_all();
+				deallocate();
+			}
+
+			MYECS_NODISCARD const TypeInfo& type()const {
+				return *info;
+			}
+
+			//a slot with no object in it yet, the caller constructs one at get(id)
+			size_t allocate() {
+				if (ids.full() && ids.max_count() == m_capacity) {
+					reallocate(growth.next_capacity(m_capacity, m_capacity + 1));
+				}
+				return ids.get();
+			}
+
+			//moves value into a new slot, or constructs it through info.construct for null
+			size_t create(void* value = nullptr) {
+				size_t id = allocate();
+				void* target = get(id);
+				//a throwing constructor gives the slot back, it holds no object to destroy later
+				try {
+					if (value) {
+						if (info->move_construct) {
+							info->move_construct(target, value);
+						}
+						else {
+							std::memcpy(target, value, info->size);
+						}
+					}
+					else if (info->construct) {
+						info->construct(target);
+					}
+					else {
+						std::memset(target, 0, info->size);
+					}
+				}
+				catch (...) {
+					ids.ret(id);
+					throw;
+				}
+				return id;
+			}
+
+			bool valid(size_t id)const {
+				return ids.active(id);
+			}
+
+			void* get(size_t id) {
+				return storage + id * info->stride();
+			}
+
+			const void* get(size_t id)const {
+				return storage + id * info->stride();
+			}
+
+			void* try_get(size_t id) {
+				if (valid(id)) {
+					return get(id);
 				}
 				return nullptr;
 			}
 
+			//slots [0, max_count()) every stride() bytes, only valid() ones hold an object
+			std::byte* data() {
+				return storage;
+			}
+
+			void prefetch(size_t id)const {
+				if (id < m_capacity) {
+					MYECS_PREFETCH(get(id));
+				}
+			}
+
+			void destroy(size_t id) {
+				if (!valid(id)) {
+					return;
+				}
+				if (info->destroy) {
+					info->destroy(get(id));
+				}
+				ids.ret(id);
+			}
+
+			size_t count()const override {
+				return ids.count();
+			}
+
+			size_t max_count()const override {
+				return ids.max_count();
+			}
+
+			size_t free_count()const {
+				return ids.free_count();
+			}
+
+			size_t capacity()const {
+				return m_capacity;
+			}
+
+			void reserve(size_t count) {
+				if (count > m_capacity) {
+					reallocate(growth.reserve_capacity(count));
+				}
+				ids.reserve(count);
+			}
+
+			//same as Pool<T>::compact
+			template<class Func>
+			void compact(Func&& moved) {
+				MYECS_PROFILE_SCOPE("RawPool::compact");
+				size_t live = ids.count();
+				size_t hole = 0;
+				for (size_t from = live; from < ids.max_count(); from++) {
+					if (!ids.active(from)) {
+						continue;
+					}
+					while (ids.active(hole)) {
+						hole++;
+					}
+					if (info->move_construct) {
+						info->move_construct(get(hole), get(from));
+						if (info->destroy) {
+							info->destroy(get(from));
+						}
+					}
+					else {
+						std::memcpy(get(hole), get(from), info->size);
+					}
+					moved(from, hole);
+					hole++;
+				}
+				ids.assign(live);
+				if (live == 0) {
+					deallocate();
+					m_capacity = 0;
+				}
+				else if (m_capacity > live) {
+					reallocate(live);
+				}
+			}
+
+			void set_growth(GrowthPolicy policy) {
+				growth = policy;
+			}
+
+			MYECS_NODISCARD GrowthPolicy growth_policy()const {
+				return growth;
+			}
+
+			size_t memory_usage()const {
+				return m_capacity * info->stride() + ids.memory_usage();
+			}
+
+			//keeps the storage for reuse
+			void clear() {
+				destroy_all();
+				ids.clear();
+			}
+		};
+
+		//slot storage for component types known at runtime, addressed by the dense id add_type returns.
+		//C++ types go through the same storage, registered by their type hash on first use
+		class ComponentMgr {
+		private:
+			std::vector<RawPool> pools;
+			std::unordered_map<size_t, id_type> native_types;
+
+			RawPool& pool_of(id_type type) {
+				MYECS_ASSERT(type < pools.size(), "unknown component type");
+				return pools[type];
+			}
+
+			const RawPool& pool_of(id_type type)const {
+				MYECS_ASSERT(type < pools.size(), "unknown component type");
+				return pools[type];
+			}
+
 		public:
 			ComponentMgr() {}
-			ComponentMgr(ComponentMgr&& other)noexcept :pools(std::move(other.pools)) {}
+			ComponentMgr(ComponentMgr&& other)noexcept :
+				pools(std::move(other.pools)),
+				native_types(std::move(other.native_types)) {
+			}
+
+			MYECS_NODISCARD id_type add_type(TypeInfo info) {
+				pools.emplace_back(std::make_shared<const TypeInfo>(std::move(info)));
+				return pools.size() - 1;
+			}
+
+			template<class T>
+			MYECS_NODISCARD id_type type_id() {
+				auto [it, inserted] = native_types.try_emplace(types::type_hash<T>(), pools.size());
+				if (inserted) {
+					pools.emplace_back(std::make_shared<const TypeInfo>(TypeInfo::of<T>()));
+				}
+				return it->second;
+			}
+
+			MYECS_NODISCARD const TypeInfo& type(id_type type)const {
+				return pool_of(type).type();
+			}
+
+			MYECS_NODISCARD size_t type_count()const {
+				return pools.size();
+			}
+
+			MYECS_NODISCARD RawPool& pool(id_type type) {
+				return pool_of(type);
+			}
+
+			size_t emplace(id_type type, void* value = nullptr) {
+				return pool_of(type).create(value);
+			}
+
+			MYECS_NODISCARD void* get(id_type type, size_t c) {
+				return pool_of(type).get(c);
+			}
+
+			MYECS_NODISCARD void* try_get(id_type type, size_t c) {
+				return type < pools.size() ? pools[type].try_get(c) : nullptr;
+			}
+
+			void destroy(id_type type, size_t c) {
+				pool_of(type).destroy(c);
+			}
+
+			MYECS_NODISCARD bool valid(id_type type, size_t c)const {
+				return type < pools.size() && pools[type].valid(c);
+			}
 
 			template<class T, class ...Args>
 			size_t emplace(Args&&... args) {
-				return get_pool<T>()->create(std::forward<Args>(args)...);
+				RawPool& pool = pool_of(type_id<T>());
+				size_t c = pool.allocate();
+				new (pool.get(c)) T(std::forward<Args>(args)...);
+				return c;
 			}
 
 			template<class T>
 			T& get(size_t c) {
-				return try_get_pool<T>()->get(c);
+				return *std::launder(reinterpret_cast<T*>(get(type_id<T>(), c)));
 			}
 
 			template<class T>
 			T* try_get(size_t c) {
-				if (auto p = try_get_pool<T>()) {
-					return p->try_get(c);
-				}
-				return nullptr;
+				return static_cast<T*>(try_get(type_id<T>(), c));
 			}
 
 			template<class T>
 			void destroy(size_t c) {
-				try_get_pool<T>()->destroy(c);
+				destroy(type_id<T>(), c);
 			}
 
 			template<class T>
-			bool valid(size_t c) const {
-				if (auto p = try_get_pool<T>()) {
-					return p->valid(c);
-				}
-				return false;
+			bool valid(size_t c)const {
+				auto it = native_types.find(types::type_hash<T>());
+				return it != native_types.end() && valid(it->second, c);
 			}
 		};
 	}//namespace pool
@@ -0,0 +1,94 @@
+#pragma once
+#ifndef MYECS_PREFAB_H
+#define MYECS_PREFAB_H
+
+#include<memory>
+#include<stdexcept>
+#include<vector>
+#include"types.h"
+
+
+namespace myecs {
+
+	class Registry;
+
+	//a component set with values, captured once and stamped onto new entities by
+	//Registry::instantiate(prefab, n). copies of a prefab share the captured values
+	class Prefab {
+	private:
+		friend class Registry;
+
+		struct Component {
+			size_t type;
+			std::shared_ptr<const void> value;
+			void (*instantiate)(Registry& reg, const void* value, const entity* entities, size_t count);
+			id_type (*component_id)();
+		};
+
+		std::vector<Component> components;
+
+		template<class T, class R>
+		static void instantiate_component(R& reg, const void* value, const entity* entities, size_t count) {
+			reg.template emplace_bulk<T>(entities, count, *static_cast<const T*>(value));
+		}
+
+		template<class T, class R>
+		static id_type component_id_of() {
+			return R::template component_id<T>();
+		}
+
+		template<class T>
+		const Component* find()const {
+			for (const auto& c : components) {
+				if (c.type == types::type_hash<T>()) {
+					return &c;
+				}
+			}
+			return nullptr;
+		}
+
+	public:
+		//adds T constructed from args, or replaces the value T already had
+		template<class T, class ...Args>
+		Prefab& set(Args&&... args) {
+			Component c{ types::type_hash<T>(), std::make_shared<const T>(std::forward<Args>(args)...),
+						 &instantiate_component<T, Registry>, &component_id_of<T, Registry> };
+			for (auto& old : components) {
+				if (old.type == c.type) {
+					old = std::move(c);
+					return *this;
+				}
+			}
+			components.push_back(std::move(c));
+			return *this;
+		}
+
+		template<class T>
+		void remove() {
+			std::erase_if(components, [](const Component& c) {
+				return c.type == types::type_hash<T>();
+			});
+		}
+
+		template<class T>
+		MYECS_NODISCARD bool has()const {
+			return find<T>() != nullptr;
+		}
+
+		template<class T>
+		MYECS_NODISCARD const T& get()const {
+			const Component* c = find<T>();
+			if (!c) {
+				throw std::runtime_error("prefab has no such component");
+			}
+			return *static_cast<const T*>(c->value.get());
+		}
+
+		MYECS_NODISCARD size_t size()const {
+			return components.size();
+		}
+	};
+
+}//namespace myecs
+
+#endif
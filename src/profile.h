@@ -0,0 +1,233 @@
+#pragma once
+#ifndef MYECS_PROFILE_H
+#define MYECS_PROFILE_H
+
+#include"types.h"
+
+//hot path instrumentation, compiled out unless MYECS_PROFILE is defined
+//MYECS_PROFILE_SCOPE("name");		times the enclosing scope, name must be a string literal
+//MYECS_PROFILE_COUNT(Counter, n);	adds n to one of the profile::Counter values
+//
+//every thread writes into its own buffer without locks, exporting reads all buffers
+//and should happen at a quiet point (e.g. between frames) to avoid torn events
+
+#ifdef MYECS_PROFILE
+
+#include<algorithm>
+#include<array>
+#include<atomic>
+#include<chrono>
+#include<map>
+#include<memory>
+#include<mutex>
+#include<ostream>
+#include<vector>
+
+namespace myecs::profile {
+
+	enum class Counter : size_t {
+		rehash,				//DenseMap::rehash calls
+		reallocation,		//storage growth that moves every element
+		bytes_moved,		//bytes relocated by rehash and reallocation
+		entity_destroy,		//Registry::destroy(entity) calls
+		component_destroy,	//components removed by Registry::destroy(entity)
+		_count
+	};
+
+	inline constexpr std::array<const char*, static_cast<size_t>(Counter::_count)> counter_names = {
+		"rehash", "reallocation", "bytes_moved", "entity_destroy", "component_destroy"
+	};
+
+	struct Event {
+		const char* name = nullptr;
+		types::u64 begin_ns = 0;
+		types::u64 duration_ns = 0;
+	};
+
+	class ThreadBuffer {
+	public:
+		static constexpr size_t capacity = 1 << 16;
+
+	private:
+		std::unique_ptr<Event[]> events = std::make_unique<Event[]>(capacity);
+		//total events ever recorded, slot is written % capacity so old events get overwritten
+		std::atomic<size_t> written = 0;
+		std::array<std::atomic<types::u64>, static_cast<size_t>(Counter::_count)> counters{};
+
+	public:
+		const size_t thread_index;
+
+		explicit ThreadBuffer(size_t thread_index) :thread_index(thread_index) {}
+
+		void record(const char* name, types::u64 begin_ns, types::u64 duration_ns) {
+			size_t i = written.load(std::memory_order_relaxed);
+			events[i & (capacity - 1)] = { name, begin_ns, duration_ns };
+			written.store(i + 1, std::memory_order_release);
+		}
+
+		//single writer, so a plain load and store is enough
+		void add(Counter c, types::u64 n) {
+			auto& counter = counters[static_cast<size_t>(c)];
+			counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+		}
+
+		MYECS_NODISCARD types::u64 get(Counter c)const {
+			return counters[static_cast<size_t>(c)].load(std::memory_order_relaxed);
+		}
+
+		template<class Func>
+		void for_each(Func&& func)const {
+			size_t end = written.load(std::memory_order_acquire);
+			size_t begin = end > capacity ? end - capacity : 0;
+			for (size_t i = begin; i < end; i++) {
+				func(events[i & (capacity - 1)]);
+			}
+		}
+
+		void reset() {
+			written.store(0, std::memory_order_relaxed);
+			for (auto& counter : counters) {
+				counter.store(0, std::memory_order_relaxed);
+			}
+		}
+	};
+
+	namespace internal {
+		struct Buffers {
+			std::mutex mutex;
+			//buffers outlive their threads so exporting after a join still sees them
+			std::vector<std::unique_ptr<ThreadBuffer>> list;
+		};
+
+		inline Buffers& buffers() {
+			static Buffers ret;
+			return ret;
+		}
+
+		inline ThreadBuffer& local() {
+			thread_local ThreadBuffer* buffer = [] {
+				Buffers& all = buffers();
+				std::lock_guard lock(all.mutex);
+				all.list.push_back(std::make_unique<ThreadBuffer>(all.list.size()));
+				return all.list.back().get();
+			}();
+			return *buffer;
+		}
+
+		inline types::u64 now_ns() {
+			static const auto epoch = std::chrono::steady_clock::now();
+			return static_cast<types::u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - epoch).count());
+		}
+	}
+
+	inline void count(Counter c, types::u64 n = 1) {
+		internal::local().add(c, n);
+	}
+
+	class Scope {
+	private:
+		const char* name;
+		types::u64 begin;
+
+	public:
+		explicit Scope(const char* name) :name(name), begin(internal::now_ns()) {}
+		Scope(const Scope&) = delete;
+		~Scope() {
+			internal::local().record(name, begin, internal::now_ns() - begin);
+		}
+	};
+
+	MYECS_NODISCARD inline types::u64 total(Counter c) {
+		internal::Buffers& all = internal::buffers();
+		std::lock_guard lock(all.mutex);
+		types::u64 ret = 0;
+		for (const auto& buffer : all.list) {
+			ret += buffer->get(c);
+		}
+		return ret;
+	}
+
+	//chrome://tracing and perfetto format, counters are emitted as one "C" event per thread
+	inline void write_chrome_trace(std::ostream& out) {
+		internal::Buffers& all = internal::buffers();
+		std::lock_guard lock(all.mutex);
+		out << "{\"traceEvents\":[";
+		bool first = true;
+		for (const auto& buffer : all.list) {
+			buffer->for_each([&](const Event& e) {
+				out << (first ? "\n" : ",\n")
+					<< "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->thread_index
+					<< ",\"ts\":" << static_cast<double>(e.begin_ns) / 1000.0
+					<< ",\"dur\":" << static_cast<double>(e.duration_ns) / 1000.0 << "}";
+				first = false;
+			});
+			out << (first ? "\n" : ",\n")
+				<< "{\"name\":\"counters\",\"ph\":\"C\",\"pid\":0,\"tid\":" << buffer->thread_index
+				<< ",\"ts\":" << static_cast<double>(internal::now_ns()) / 1000.0 << ",\"args\":{";
+			for (size_t c = 0; c < counter_names.size(); c++) {
+				out << (c ? "," : "") << "\"" << counter_names[c] << "\":" << buffer->get(static_cast<Counter>(c));
+			}
+			out << "}}";
+			first = false;
+		}
+		out << "\n]}\n";
+	}
+
+	//one line per scope name (calls, total and max time) followed by the counters
+	inline void write_summary(std::ostream& out) {
+		struct Entry {
+			types::u64 calls = 0;
+			types::u64 total_ns = 0;
+			types::u64 max_ns = 0;
+		};
+		std::map<std::string_view, Entry> entries;
+		std::array<types::u64, counter_names.size()> counters{};
+		{
+			internal::Buffers& all = internal::buffers();
+			std::lock_guard lock(all.mutex);
+			for (const auto& buffer : all.list) {
+				buffer->for_each([&](const Event& e) {
+					Entry& entry = entries[e.name];
+					entry.calls++;
+					entry.total_ns += e.duration_ns;
+					entry.max_ns = std::max(entry.max_ns, e.duration_ns);
+				});
+				for (size_t c = 0; c < counters.size(); c++) {
+					counters[c] += buffer->get(static_cast<Counter>(c));
+				}
+			}
+		}
+		for (const auto& [name, entry] : entries) {
+			out << name << ": calls=" << entry.calls
+				<< " total_us=" << static_cast<double>(entry.total_ns) / 1000.0
+				<< " max_us=" << static_cast<double>(entry.max_ns) / 1000.0 << "\n";
+		}
+		for (size_t c = 0; c < counters.size(); c++) {
+			out << counter_names[c] << ": " << counters[c] << "\n";
+		}
+	}
+
+	inline void reset() {
+		internal::Buffers& all = internal::buffers();
+		std::lock_guard lock(all.mutex);
+		for (const auto& buffer : all.list) {
+			buffer->reset();
+		}
+	}
+
+}//namespace myecs::profile
+
+#define MYECS_PROFILE_CONCAT_IMPL(a, b) a##b
+#define MYECS_PROFILE_CONCAT(a, b) MYECS_PROFILE_CONCAT_IMPL(a, b)
+#define MYECS_PROFILE_SCOPE(name) ::myecs::profile::Scope MYECS_PROFILE_CONCAT(_myecs_profile_scope_, __LINE__)(name)
+#define MYECS_PROFILE_COUNT(which, n) ::myecs::profile::count(::myecs::profile::Counter::which, (n))
+
+#else
+
+#define MYECS_PROFILE_SCOPE(name) void(0)
+#define MYECS_PROFILE_COUNT(which, n) void(0)
+
+#endif
+
+#endif
@@ -0,0 +1,218 @@
+#pragma once
+#ifndef MYECS_QUERY_H
+#define MYECS_QUERY_H
+
+#include<algorithm>
+#include<chrono>
+#include"component.h"
+
+
+namespace myecs {
+
+	enum class QueryStrategy {
+		probe,		//iterate the driver pool, probe the others with has()
+		bitmap		//AND the occupancy bitmaps of all pools
+	};
+
+	//view<Types...>(exclude<Excluded...>) skips entities owning any of Excluded
+	template<class ...Types>
+	struct exclude_t {
+		explicit constexpr exclude_t() = default;
+	};
+
+	template<class ...Types>
+	inline constexpr exclude_t<Types...> exclude{};
+
+	//how Registry::view<Types...>() evaluates one component set
+	struct QueryPlan {
+		QueryStrategy strategy = QueryStrategy::probe;
+		//indices into the component list, driver first then probes from most to least selective
+		IntVector<size_t> order;
+		//pool sizes the plan was made for
+		IntVector<size_t> sizes;
+		double estimated_cost = 0.0;
+
+		//a plan goes stale once any pool doubled or halved since planning
+		MYECS_NODISCARD bool fits(const IComponentPool* const* pools, size_t count)const {
+			if (sizes.size() != count) {
+				return false;
+			}
+			for (size_t i = 0; i < count; i++) {
+				size_t planned = sizes[i] + slack;
+				size_t current = pools[i]->count() + slack;
+				if (current > planned * 2 || planned > current * 2) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+	private:
+		//keeps tiny pools from replanning on every insertion
+		static constexpr size_t slack = 64;
+	};
+
+	//limits one Registry::resume call, zero means no limit
+	struct CursorBudget {
+		size_t max_entities = 0;
+		std::chrono::nanoseconds max_time{};
+	};
+
+	//saved position of an incremental pass over view<Types...>(), see Registry::resume.
+	//the position is an entity id, not an index into a dense array, so swap-and-pop erasure
+	//never moves unvisited entities behind it: every entity owning Types for the whole pass
+	//is visited exactly once, entities created behind the cursor wait for the next pass
+	template<class ...Types>
+	class ViewCursor {
+	private:
+		friend class Registry;
+
+		size_t next_id = 0;
+		size_t pass_count = 0;
+		size_t visited_count = 0;
+
+	public:
+		//next entity id to look at
+		MYECS_NODISCARD size_t position()const {
+			return next_id;
+		}
+
+		//completed passes
+		MYECS_NODISCARD size_t passes()const {
+			return pass_count;
+		}
+
+		//entities visited in the current pass
+		MYECS_NODISCARD size_t visited()const {
+			return visited_count;
+		}
+
+		//restart the current pass from the first id
+		void rewind() {
+			next_id = 0;
+			visited_count = 0;
+		}
+	};
+
+	//picks driver, probe order and strategy from pool sizes and their density over the id range
+	//the costs are rough per operation estimates (in ns) taken from myecs_bench
+	class QueryPlanner {
+	public:
+		static constexpr double iterate_cost = 0.5;		//reading one entity of the driver
+		static constexpr double probe_cost = 2.0;		//one has() on a secondary pool
+		static constexpr double word_cost = 0.25;		//ANDing one bitmap word of one pool
+		static constexpr double emit_cost = 1.0;		//writing one match
+
+		MYECS_NODISCARD static QueryPlan make(const IComponentPool* const* pools, size_t count, size_t id_range) {
+			QueryPlan plan;
+			for (size_t i = 0; i < count; i++) {
+				plan.order.emplace_back(i);
+				plan.sizes.emplace_back(pools[i]->count());
+			}
+			if (count == 0) {
+				return plan;
+			}
+			std::sort(&plan.order[0], &plan.order[0] + count, [&](size_t a, size_t b) {
+				return plan.sizes[a] < plan.sizes[b];
+			});
+
+			double range = static_cast<double>(std::max<size_t>(id_range, 1));
+			//expected has() calls when every probe keeps its pool's density of the survivors
+			double driver = static_cast<double>(plan.sizes[plan.order[0]]);
+			double survivors = driver;
+			double probes = 0.0;
+			for (size_t k = 1; k < count; k++) {
+				probes += survivors;
+				survivors *= std::min(1.0, static_cast<double>(plan.sizes[plan.order[k]]) / range);
+			}
+			double probe = driver * iterate_cost + probes * probe_cost + survivors * emit_cost;
+
+			size_t words = pools[0]->occupancy().word_count();
+			for (size_t i = 1; i < count; i++) {
+				words = std::min(words, pools[i]->occupancy().word_count());
+			}
+			double bitmap = static_cast<double>(words * count) * word_cost + survivors * emit_cost;
+
+			if (count >= 2 && bitmap < probe) {
+				plan.strategy = QueryStrategy::bitmap;
+				plan.estimated_cost = bitmap;
+			}
+			else {
+				plan.strategy = QueryStrategy::probe;
+				plan.estimated_cost = probe;
+			}
+			return plan;
+		}
+	};
+
+	//maintenance report of a persistent query, see Registry::query_stats
+	struct PersistentQueryStats {
+		size_t matches = 0;
+		size_t reads = 0;		//persistent_view() calls
+		size_t checks = 0;		//emplaces that had to test the whole component set
+		size_t inserts = 0;
+		size_t erases = 0;
+		double maintenance_cost = 0.0;	//estimated ns spent keeping the matches current
+		double query_cost = 0.0;		//estimated ns of one planned view of the same set right now
+
+		//whether the reads so far would have cost more as planned views
+		MYECS_NODISCARD bool pays_off()const {
+			return static_cast<double>(reads) * query_cost > maintenance_cost;
+		}
+	};
+
+	//matches of one component set, kept current by the Registry on every emplace and destroy
+	//of its components, see Registry::persist
+	class PersistentQuery {
+	private:
+		friend class Registry;
+
+		IntVector<id_type> components;
+		SparseSet<entity> matches;
+		size_t reads = 0;
+		size_t checks = 0;
+		size_t inserts = 0;
+		size_t erases = 0;
+
+		void insert(entity e) {
+			matches.insert(e);
+			inserts++;
+		}
+
+		void erase(entity e) {
+			if (matches.has(e)) {
+				matches.erase(e);
+				erases++;
+			}
+		}
+
+	public:
+		MYECS_NODISCARD const SparseSet<entity>& view()const {
+			return matches;
+		}
+
+		MYECS_NODISCARD size_t size()const {
+			return matches.size();
+		}
+
+		//component ids (not types) the query matches on
+		MYECS_NODISCARD const IntVector<id_type>& component_ids()const {
+			return components;
+		}
+
+		MYECS_NODISCARD PersistentQueryStats stats()const {
+			PersistentQueryStats ret;
+			ret.matches = matches.size();
+			ret.reads = reads;
+			ret.checks = checks;
+			ret.inserts = inserts;
+			ret.erases = erases;
+			ret.maintenance_cost = static_cast<double>(checks * components.size()) * QueryPlanner::probe_cost +
+				static_cast<double>(inserts + erases) * QueryPlanner::emit_cost;
+			return ret;
+		}
+	};
+
+}//namespace myecs
+
+#endif
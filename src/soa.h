@@ -0,0 +1,344 @@
+#pragma once
+#ifndef MYECS_SOA_H
+#define MYECS_SOA_H
+
+#include<memory>
+#include<span>
+#include<tuple>
+#include<utility>
+#include<vector>
+#include"pool.h"
+
+
+namespace myecs {
+
+	//structure of arrays storage is opt in per component type by listing its fields:
+	//template<> struct myecs::soa_traits<Transform> :myecs::soa_layout<&Transform::x, &Transform::y> {};
+	//every listed field gets its own array. the list must cover T, a layout that misses or repeats a field does not compile
+	template<class T>
+	struct soa_traits {
+		static constexpr bool enabled = false;
+	};
+
+	template<class T>
+	concept soa_component = soa_traits<T>::enabled;
+
+	namespace internal {
+		template<class Member>
+		struct member_traits;
+
+		template<class Class, class Field>
+		struct member_traits<Field Class::*> {
+			using class_type = Class;
+			using field_type = Field;
+		};
+
+		//converts to any field type, probes how many initializers an aggregate takes
+		struct any_field {
+			template<class U>
+			operator U& ()const&&;
+		};
+
+		template<class T, class ...Fields>
+		consteval size_t aggregate_field_count() {
+			if constexpr (requires { T{ Fields{}..., any_field{} }; }) {
+				return aggregate_field_count<T, Fields..., any_field>();
+			}
+			else {
+				return sizeof...(Fields);
+			}
+		}
+
+		//aggregates must list as many fields as they have members, other types as many bytes as they
+		//take (so padded non aggregates can not be checked and are rejected as well)
+		template<class T, size_t FieldCount, size_t FieldBytes>
+		consteval bool soa_covers() {
+			if constexpr (std::is_aggregate_v<T>) {
+				return aggregate_field_count<T>() == FieldCount;
+			}
+			else {
+				return FieldBytes == sizeof(T);
+			}
+		}
+	}
+
+	template<auto ...Members>
+	struct soa_layout {
+		static_assert(sizeof...(Members) > 0, "soa layout needs at least one field");
+
+		static constexpr bool enabled = true;
+		static constexpr size_t field_count = sizeof...(Members);
+
+		using fields = std::tuple<typename internal::member_traits<decltype(Members)>::field_type...>;
+		using arrays = std::tuple<std::vector<typename internal::member_traits<decltype(Members)>::field_type>...>;
+		using pointers = std::tuple<typename internal::member_traits<decltype(Members)>::field_type*...>;
+		using spans = std::tuple<std::span<typename internal::member_traits<decltype(Members)>::field_type>...>;
+
+		template<size_t I>
+		static constexpr auto member = std::get<I>(std::make_tuple(Members...));
+
+		//position of Member in the layout
+		template<auto Member>
+		static constexpr size_t index_of() {
+			return find<Member>(std::make_index_sequence<field_count>{});
+		}
+
+		//bytes of one slot over all field arrays
+		static constexpr size_t field_bytes = (sizeof(typename internal::member_traits<decltype(Members)>::field_type) + ...);
+
+		//no member listed twice
+		static constexpr bool distinct() {
+			constexpr auto members = std::make_tuple(Members...);
+			bool ret = true;
+			[&]<size_t ...I>(std::index_sequence<I...>) {
+				((ret = ret && index_of<std::get<I>(members)>() == I), ...);
+			}(std::make_index_sequence<field_count>{});
+			return ret;
+		}
+
+	private:
+		template<auto Member, size_t ...I>
+		static constexpr size_t find(std::index_sequence<I...>) {
+			size_t ret = field_count;
+			([&] {
+				if constexpr (std::is_same_v<std::remove_cv_t<decltype(member<I>)>, std::remove_cv_t<decltype(Member)>>) {
+					if (member<I> == Member) {
+						ret = I;
+					}
+				}
+			}(), ...);
+			return ret;
+		}
+	};
+
+	//what get<T>() returns for a soa component: references into the field arrays of one slot.
+	//read fields with ref.get<&T::x>() or a structured binding in layout order,
+	//converts to a T copy and assigns from a T
+	template<class T>
+	class SoaRef {
+	private:
+		using layout = soa_traits<T>;
+		typename layout::pointers ptrs;
+
+		template<size_t ...I>
+		T load(std::index_sequence<I...>)const {
+			T ret{};
+			((ret.*layout::template member<I> = *std::get<I>(ptrs)), ...);
+			return ret;
+		}
+
+		template<size_t ...I>
+		void store(const T& value, std::index_sequence<I...>)const {
+			((*std::get<I>(ptrs) = value.*layout::template member<I>), ...);
+		}
+
+	public:
+		explicit SoaRef(typename layout::pointers ptrs) :ptrs(ptrs) {}
+
+		template<size_t I>
+		MYECS_NODISCARD auto& get()const {
+			return *std::get<I>(ptrs);
+		}
+
+		template<auto Member>
+			requires (layout::template index_of<Member>() < layout::field_count)
+		MYECS_NODISCARD auto& get()const {
+			return *std::get<layout::template index_of<Member>()>(ptrs);
+		}
+
+		operator T()const {
+			return load(std::make_index_sequence<layout::field_count>{});
+		}
+
+		const SoaRef& operator=(const T& value)const {
+			store(value, std::make_index_sequence<layout::field_count>{});
+			return *this;
+		}
+	};
+
+	namespace pool {
+		//same slot allocation as Pool<T>, but every field of T lives in its own array.
+		//the arrays sit behind one pointer so the pool keeps the size of a Pool<T>
+		template<soa_component T>
+		class SoaPool :public IPool {
+		private:
+			using layout = soa_traits<T>;
+			using arrays = typename layout::arrays;
+			static constexpr size_t field_count = layout::field_count;
+
+			static_assert(layout::distinct(), "soa layout lists a field twice");
+			static_assert(internal::soa_covers<T, field_count, layout::field_bytes>(),
+						  "soa layout must list every field of the component, fields left out would be lost on every store");
+
+			std::unique_ptr<arrays> fields = std::make_unique<arrays>();
+			IdGen<size_t> ids;
+			GrowthPolicy growth;
+
+			void reserve_fields(size_t new_capacity) {
+				MYECS_CHECK_ALLOCATION(true);
+				std::apply([&](auto&... array) {
+					(array.reserve(new_capacity), ...);
+				}, *fields);
+			}
+
+			template<size_t ...I>
+			void append(const T& value, std::index_sequence<I...>) {
+				(std::get<I>(*fields).push_back(value.*layout::template member<I>), ...);
+			}
+
+			template<size_t ...I>
+			typename layout::pointers pointers(size_t id, std::index_sequence<I...>) {
+				return { (std::get<I>(*fields).data() + id)... };
+			}
+
+			template<size_t ...I>
+			typename layout::spans make_spans(size_t begin, size_t count, std::index_sequence<I...>) {
+				return { std::span(std::get<I>(*fields).data() + begin, count)... };
+			}
+
+		public:
+			SoaPool() {}
+			SoaPool(SoaPool&& other)noexcept :
+				fields(std::move(other.fields)),
+				ids(std::move(other.ids)),
+				growth(other.growth) {
+				other.fields = std::make_unique<arrays>();
+			}
+
+			template<class ...Args>
+			size_t create(Args&&... args) {
+				T value(std::forward<Args>(args)...);
+				bool grow = ids.full();
+				if (grow && ids.max_count() == capacity()) {
+					reserve_fields(growth.next_capacity(capacity(), ids.max_count() + 1));
+				}
+				size_t id = ids.get();
+				if (grow) {
+					append(value, std::make_index_sequence<field_count>{});
+				}
+				else {
+					get(id) = value;
+				}
+				return id;
+			}
+
+			void create_bulk(size_t count, const T& value, size_t* out) {
+				size_t required = ids.max_count() + count - std::min(count, ids.free_count());
+				if (required > capacity()) {
+					reserve_fields(growth.next_capacity(capacity(), required));
+				}
+				for (size_t i = 0; i < count; i++) {
+					out[i] = create(value);
+				}
+			}
+
+			bool valid(size_t id)const {
+				return ids.active(id);
+			}
+
+			SoaRef<T> get(size_t id) {
+				return SoaRef<T>(pointers(id, std::make_index_sequence<field_count>{}));
+			}
+
+			void prefetch(size_t id)const {
+				std::apply([&](const auto&... array) {
+					((id < array.size() ? MYECS_PREFETCH(array.data() + id) : void(0)), ...);
+				}, *fields);
+			}
+
+			//one span per field over slots [begin, begin + count)
+			typename layout::spans spans(size_t begin, size_t count) {
+				return make_spans(begin, count, std::make_index_sequence<field_count>{});
+			}
+
+			//field values of a destroyed slot are left in place until the slot is reused
+			void destroy(size_t id) {
+				ids.ret(id);
+			}
+
+			size_t count()const override {
+				return ids.count();
+			}
+
+			size_t max_count()const override {
+				return ids.max_count();
+			}
+
+			size_t free_count()const {
+				return ids.free_count();
+			}
+
+			size_t capacity()const {
+				return std::get<0>(*fields).capacity();
+			}
+
+			void reserve(size_t count) {
+				if (count > capacity()) {
+					reserve_fields(growth.reserve_capacity(count));
+				}
+				ids.reserve(count);
+			}
+
+			//same as Pool<T>::compact, field by field
+			template<class Func>
+			void compact(Func&& moved) {
+				MYECS_PROFILE_SCOPE("SoaPool::compact");
+				size_t live = ids.count();
+				size_t hole = 0;
+				for (size_t from = live; from < ids.max_count(); from++) {
+					if (!ids.active(from)) {
+						continue;
+					}
+					while (ids.active(hole)) {
+						hole++;
+					}
+					std::apply([&](auto&... array) {
+						((array[hole] = std::move(array[from])), ...);
+					}, *fields);
+					moved(from, hole);
+					hole++;
+				}
+				ids.assign(live);
+				std::apply([&](auto&... array) {
+					((array.erase(array.begin() + live, array.end()), array.shrink_to_fit()), ...);
+				}, *fields);
+			}
+
+			void set_growth(GrowthPolicy policy) {
+				growth = policy;
+			}
+
+			MYECS_NODISCARD GrowthPolicy growth_policy()const {
+				return growth;
+			}
+
+			size_t memory_usage()const {
+				size_t ret = ids.memory_usage();
+				std::apply([&](const auto&... array) {
+					((ret += array.capacity() * sizeof(array[0])), ...);
+				}, *fields);
+				return ret;
+			}
+
+			void clear() {
+				std::apply([](auto&... array) {
+					(array.clear(), ...);
+				}, *fields);
+				ids.clear();
+			}
+		};
+	}//namespace pool
+
+}//namespace myecs
+
+namespace std {
+	template<class T>
+	struct tuple_size<myecs::SoaRef<T>> :integral_constant<size_t, myecs::soa_traits<T>::field_count> {};
+
+	template<size_t I, class T>
+	struct tuple_element<I, myecs::SoaRef<T>> {
+		using type = tuple_element_t<I, typename myecs::soa_traits<T>::fields>&;
+	};
+}//namespace std
+
+#endif
@@ -0,0 +1,243 @@
+#pragma once
+#ifndef MYECS_STATIC_REGISTRY_H
+#define MYECS_STATIC_REGISTRY_H
+
+#include<bitset>
+#include<tuple>
+#include"component.h"
+
+
+namespace myecs {
+
+	//Registry for a component list fixed at compile time: the pools sit in a tuple, component
+	//indices are constants and every entity carries a bitset signature, so no call goes through
+	//type ids, ClassData or a virtual function. same api shape as Registry
+	template<class ...Components>
+	class StaticRegistry {
+	public:
+		static constexpr size_t component_count_v = sizeof...(Components);
+		using signature = std::bitset<component_count_v>;
+		using archetype_view = IComponentPool::archetype_view;
+
+		//position of T in Components
+		template<class T>
+		static constexpr size_t index_of = [] {
+			constexpr bool same[] = { std::is_same_v<T, Components>... };
+			for (size_t i = 0; i < component_count_v; i++) {
+				if (same[i]) {
+					return i;
+				}
+			}
+			return component_count_v;
+		}();
+
+		template<class T>
+		static constexpr bool contains_v = index_of<T> < component_count_v;
+
+	private:
+		static_assert(sizeof...(Components) > 0, "static registry needs at least one component");
+
+		std::tuple<ComponentPool<Components>...> pools;
+		IdGen<entity> ids;
+		std::vector<signature> signatures;
+
+		template<class T>
+		ComponentPool<T>& pool() {
+			return std::get<index_of<T>>(pools);
+		}
+
+		template<class T>
+		const ComponentPool<T>& pool()const {
+			return std::get<index_of<T>>(pools);
+		}
+
+		template<class ...Types>
+		static signature mask() {
+			signature ret;
+			(ret.set(index_of<Types>), ...);
+			return ret;
+		}
+
+		template<size_t ...I>
+		void destroy_components(entity e, const signature& s, std::index_sequence<I...>) {
+			((s.test(I) ? std::get<I>(pools).destroy(e) : void(0)), ...);
+		}
+
+	public:
+		StaticRegistry() = default;
+		StaticRegistry(StaticRegistry&&) noexcept = default;
+		StaticRegistry(const StaticRegistry&) = delete;
+
+		MYECS_NODISCARD entity create() {
+			entity e = ids.get();
+			if (signatures.size() <= e.get_id()) {
+				signatures.resize(e.get_id() + 1);
+			}
+			return e;
+		}
+
+		//only the pools named in the signature are touched, unrolled over Components
+		void destroy(entity e) {
+			if (!ids.active(e)) {
+				return;
+			}
+			ids.ret(e);
+			signature& s = signatures[e.get_id()];
+			destroy_components(e, s, std::index_sequence_for<Components...>{});
+			s.reset();
+		}
+
+		template<class ...Types>
+			requires (sizeof...(Types) >= 1 && (contains_v<Types> && ...))
+		void destroy(entity e) {
+			if (!ids.active(e)) {
+				return;
+			}
+			signature& s = signatures[e.get_id()];
+			((pool<Types>().destroy(e), s.reset(index_of<Types>)), ...);
+		}
+
+		MYECS_NODISCARD bool valid(entity e)const {
+			return ids.active(e);
+		}
+
+		template<class T, class ...Args>
+			requires contains_v<T>
+		decltype(auto) emplace(entity e, Args&&... args) {
+			if constexpr (myecs_debug_level) {
+				if (!ids.active(e)) {
+					throw std::runtime_error("invalid entity");
+				}
+			}
+			signatures[e.get_id()].set(index_of<T>);
+			return pool<T>().create(e, std::forward<Args>(args)...);
+		}
+
+		template<class T, class ...Args>
+			requires contains_v<T>
+		decltype(auto) get_or_emplace(entity e, Args&&... args) {
+			if (has<T>(e)) {
+				return pool<T>().get(e);
+			}
+			return emplace<T>(e, std::forward<Args>(args)...);
+		}
+
+		template<class ...Types>
+		decltype(auto) emplace_all(entity e, const Types&... types) {
+			return std::tuple<decltype(emplace<Types>(e, types))...>(emplace<Types>(e, types)...);
+		}
+
+		//one masked compare on the signature, the entity version is checked as well
+		template<class ...Types>
+			requires (sizeof...(Types) >= 1 && (contains_v<Types> && ...))
+		MYECS_NODISCARD bool has(entity e)const {
+			if (!ids.active(e)) {
+				return false;
+			}
+			signature m = mask<Types...>();
+			return (signatures[e.get_id()] & m) == m;
+		}
+
+		template<class T>
+			requires contains_v<T>
+		MYECS_NODISCARD decltype(auto) get(entity e) {
+			if constexpr (myecs_debug_level) {
+				if (!valid(e)) {
+					throw std::runtime_error("invalid entity");
+				}
+			}
+			return pool<T>().get(e);
+		}
+
+		template<class ...Types>
+			requires (sizeof...(Types) >= 2)
+		MYECS_NODISCARD decltype(auto) get(entity e) {
+			return std::tuple<decltype(get<Types>(e))...>(get<Types>(e)...);
+		}
+
+		template<class T>
+			requires (contains_v<T> && !soa_component<T>)
+		MYECS_NODISCARD T* try_get(entity e) {
+			return has<T>(e) ? &pool<T>().get(e) : nullptr;
+		}
+
+		MYECS_NODISCARD const signature& signature_of(entity e)const {
+			return signatures[e.get_id()];
+		}
+
+		template<class T>
+			requires contains_v<T>
+		MYECS_NODISCARD archetype_view view() {
+			return pool<T>().view();
+		}
+
+		//drives from the smallest pool and tests signatures, no probing of other pools
+		template<class ...Types>
+			requires (sizeof...(Types) >= 2 && (contains_v<Types> && ...))
+		MYECS_NODISCARD IntVector<entity> view() {
+			signature m = mask<Types...>();
+			IntVector<entity> ret;
+			for (entity e : smallest<Types...>()) {
+				if ((signatures[e.get_id()] & m) == m) {
+					ret.emplace_back(e);
+				}
+			}
+			return ret;
+		}
+
+		//calls func(entity, components...) for every entity owning all Types
+		template<class ...Types, class Func>
+			requires (sizeof...(Types) >= 1 && (contains_v<Types> && ...))
+		void each(Func&& func) {
+			signature m = mask<Types...>();
+			std::tuple<ComponentPool<Types>&...> query_pools = { pool<Types>()... };
+			archetype_view driver = smallest<Types...>();
+			for (entity e : driver) {
+				if ((signatures[e.get_id()] & m) == m) {
+					std::apply([&](auto&... pools) {
+						func(e, pools.get(e)...);
+					}, query_pools);
+				}
+			}
+		}
+
+		void reset() {
+			ids.clear();
+			signatures.clear();
+			std::apply([](auto&... pools) {
+				(pools.clear(), ...);
+			}, pools);
+		}
+
+		MYECS_NODISCARD size_t entity_count()const {
+			return ids.count();
+		}
+
+		MYECS_NODISCARD size_t max_entity_count()const {
+			return ids.max_count();
+		}
+
+		MYECS_NODISCARD size_t component_count()const {
+			return std::apply([](const auto&... pools) {
+				return (size_t(0) + ... + pools.count());
+			}, pools);
+		}
+
+		template<class T>
+			requires contains_v<T>
+		MYECS_NODISCARD PoolStats stats()const {
+			return pool<T>().stats();
+		}
+
+	private:
+		template<class ...Types>
+		archetype_view smallest() {
+			const SparseSet<entity>* ret = nullptr;
+			((ret = (!ret || pool<Types>().view().size() < ret->size()) ? &pool<Types>().view() : ret), ...);
+			return *ret;
+		}
+	};
+
+}//namespace myecs
+
+#endif
@@ -2,12 +2,25 @@
 #ifndef MYECS_TYPES_H
 #define MYECS_TYPES_H
 
+#include<cstdint>
+#include<functional>
 #include<limits>
-#include<xhash>
+#include<stdexcept>
 #include<string_view>
+#include<type_traits>
 
 #define MYECS_NODISCARD [[nodiscard]]
 
+#if defined(_MSC_VER)
+#define MYECS_PRETTY_FUNCTION __FUNCSIG__
+#define MYECS_PRETTY_FUNCTION_PREFIX '<'
+#define MYECS_PRETTY_FUNCTION_SUFFIX '>'
+#elif defined(__clang__) || defined(__GNUC__)
+#define MYECS_PRETTY_FUNCTION __PRETTY_FUNCTION__
+#define MYECS_PRETTY_FUNCTION_PREFIX '='
+#define MYECS_PRETTY_FUNCTION_SUFFIX ']'
+#endif
+
 namespace myecs {
 
 	//1-debug, 0-release
@@ -22,44 +35,104 @@ namespace myecs {
 	using id_type = size_t;
 
 	namespace types {
-		using u32 = unsigned __int32;
-		using u64 = unsigned __int64;
+		using u32 = std::uint32_t;
+		using u64 = std::uint64_t;
 		constexpr u64 u64_max = ::std::numeric_limits<u64>::max();
 	}
 
-	struct entity {
-		union {
-			types::u64 _entity = 0;
-			struct {
-				types::u32 id;
-				types::u32 version;
-			};
-		};
+	//layout of an entity handle: the low IdBits of Int hold the id, the next VersionBits the version.
+	//the handle with every bit set is reserved for null_entity
+	template<class Int, size_t IdBits, size_t VersionBits>
+	struct entity_traits {
+		static_assert(std::is_unsigned_v<Int>, "entity handles are unsigned integers");
+		static_assert(IdBits > 0 && VersionBits > 0 && IdBits + VersionBits <= sizeof(Int) * 8, "bits do not fit the integer");
+
+		using value_type = Int;
+		static constexpr size_t id_bits = IdBits;
+		static constexpr size_t version_bits = VersionBits;
+		static constexpr value_type id_mask = static_cast<value_type>((value_type(1) << IdBits) - 1);
+		static constexpr value_type version_mask = static_cast<value_type>((value_type(1) << VersionBits) - 1);
+		//ids [0, max_id] can be handed out, id_mask itself is left to null_entity
+		static constexpr size_t max_id = static_cast<size_t>(id_mask) - 1;
+	};
 
-		constexpr explicit entity() {};
-		constexpr entity(const entity& other) :_entity(other._entity) {}
-		constexpr explicit entity(size_t _entity) : _entity(_entity) {}
-		constexpr entity(types::u32 id, types::u32 version) : id(id), version(version) {}
-		MYECS_NODISCARD constexpr bool operator==(const entity& other)const {
-			return _entity == other._entity;
+	//the original layout: 32 bit id and 32 bit version
+	using default_entity_traits = entity_traits<types::u64, 32, 32>;
+	//half the size, for worlds below a million entities
+	using compact_entity_traits = entity_traits<types::u32, 20, 12>;
+
+	template<class Traits>
+	struct basic_entity {
+		using traits_type = Traits;
+		using value_type = typename Traits::value_type;
+
+		value_type _entity = 0;
+
+		constexpr explicit basic_entity() {};
+		constexpr explicit basic_entity(value_type _entity) : _entity(_entity) {}
+		constexpr basic_entity(size_t id, size_t version) :
+			_entity(static_cast<value_type>((static_cast<value_type>(id) & Traits::id_mask) |
+											((static_cast<value_type>(version) & Traits::version_mask) << Traits::id_bits))) {
 		}
-		entity& operator=(const entity& other) {
-			_entity = other._entity;
-			return *this;
+		MYECS_NODISCARD constexpr bool operator==(const basic_entity& other)const {
+			return _entity == other._entity;
 		}
 		MYECS_NODISCARD constexpr size_t get_id()const {
-			return static_cast<size_t>(id);
+			return static_cast<size_t>(_entity & Traits::id_mask);
+		}
+		MYECS_NODISCARD constexpr size_t get_version()const {
+			return static_cast<size_t>((_entity >> Traits::id_bits) & Traits::version_mask);
 		}
 	};
 
-	constexpr entity null_entity = std::numeric_limits<entity>::max();
+	template<class Traits>
+	constexpr basic_entity<Traits> basic_null_entity = basic_entity<Traits>(std::numeric_limits<typename Traits::value_type>::max());
+
+	//define MYECS_ENTITY_TRAITS (e.g. as ::myecs::compact_entity_traits) before including to change the handle
+	//used by Registry and every container. one setting per program: Registry, ComponentPool and Hierarchy
+	//are not templates, so translation units built with different layouts would share their symbols
+#ifndef MYECS_ENTITY_TRAITS
+#define MYECS_ENTITY_TRAITS ::myecs::default_entity_traits
+#endif
+
+	using entity = basic_entity<MYECS_ENTITY_TRAITS>;
+
+	constexpr entity null_entity = basic_null_entity<MYECS_ENTITY_TRAITS>;
+
+	namespace internal {
+		template<class Traits>
+		constexpr size_t entity_layout_key = (sizeof(typename Traits::value_type) << 16) | (Traits::id_bits << 8) | Traits::version_bits;
+
+		//the layout of the first translation unit initialized, every other one has to match it.
+		//the linker merges mismatched layouts silently, so the check runs when the program starts
+		inline size_t entity_layout = 0;
+
+		struct entity_layout_check {
+			explicit entity_layout_check(size_t layout) {
+				if (entity_layout != 0 && entity_layout != layout) {
+					throw std::logic_error("MYECS_ENTITY_TRAITS differs between translation units");
+				}
+				entity_layout = layout;
+			}
+		};
+
+		static const entity_layout_check check_entity_layout{ entity_layout_key<MYECS_ENTITY_TRAITS> };
+	}
+
+#define MYECS_STRINGIFY_(x) #x
+#define MYECS_STRINGIFY(x) MYECS_STRINGIFY_(x)
+#if defined(_MSC_VER)
+	//msvc refuses to link objects built with different layouts
+#pragma detect_mismatch("myecs_entity_traits", MYECS_STRINGIFY(MYECS_ENTITY_TRAITS))
+#endif
 
 	namespace types {
+		//returns auto so that the signature holds no other template brackets than Type
 		template<typename Type>
-		MYECS_NODISCARD constexpr std::string_view type_name() noexcept {
-			std::string_view pretty_function{ static_cast<const char*>(__FUNCSIG__) };
-			auto first = pretty_function.find_first_not_of(' ', pretty_function.find_first_of('<') + 1);
-			auto value = pretty_function.substr(first, pretty_function.find_last_of('>') - first);
+		MYECS_NODISCARD constexpr auto type_name() noexcept {
+			std::string_view pretty_function{ static_cast<const char*>(MYECS_PRETTY_FUNCTION) };
+			auto first = pretty_function.find_first_not_of(' ', pretty_function.find_first_of(MYECS_PRETTY_FUNCTION_PREFIX) + 1);
+			auto value = pretty_function.substr(first, pretty_function.find_last_of(MYECS_PRETTY_FUNCTION_SUFFIX) - first);
 			return value;
 		}
 
@@ -96,10 +169,10 @@ namespace myecs {
 }//namespace myecs
 
 namespace std {
-	template <>
-	struct hash<myecs::entity> {
-		size_t operator()(const myecs::entity& e) const noexcept {
-			return hash<decltype(myecs::entity::_entity)>()(e._entity);
+	template<class Traits>
+	struct hash<myecs::basic_entity<Traits>> {
+		size_t operator()(const myecs::basic_entity<Traits>& e) const noexcept {
+			return hash<typename Traits::value_type>()(e._entity);
 		}
 	};
 }//namespace std
@@ -1,14 +1,24 @@
 #pragma once
 #ifndef MYECS_UTILS_H
 #define MYECS_UTILS_H
+#include<cstddef>
 #include<type_traits>
-#include<format>
 #include<source_location>
 
 #undef max
 #undef min
 
 
+//hint the cache to load addr, never faults
+#if defined(__GNUC__) || defined(__clang__)
+#define MYECS_PREFETCH(addr) __builtin_prefetch(static_cast<const void*>(addr))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include<xmmintrin.h>
+#define MYECS_PREFETCH(addr) _mm_prefetch(reinterpret_cast<const char*>(addr), _MM_HINT_T0)
+#else
+#define MYECS_PREFETCH(addr) void(0)
+#endif
+
 namespace myecs {
 	//stolen from entt
 	[[nodiscard]] constexpr size_t fast_mod(size_t value, const std::size_t mod)noexcept {
@@ -23,9 +33,10 @@ namespace myecs {
 	namespace internal {
 		inline static void __MyAssert(bool true_when_ok, const char* msg, std::source_location location = std::source_location::current()) {
 			if (!true_when_ok) {
-				auto _msg = std::format("Assertion failed\nfile: {}\nline: {}\nfunction: {}\nmsg: {}\n",
-										location.file_name(), location.line(), location.function_name(), msg);
-				std::cerr << _msg << std::endl;;
+				std::cerr << "Assertion failed\nfile: " << location.file_name()
+					<< "\nline: " << location.line()
+					<< "\nfunction: " << location.function_name()
+					<< "\nmsg: " << msg << "\n" << std::endl;
 				std::cerr << *reinterpret_cast<int*>(0);
 			}
 		}
@@ -36,4 +47,29 @@ namespace myecs {
 #define MYECS_ASSERT(true_when_ok, msg) void(0)
 #endif
 
+namespace myecs {
+	namespace internal {
+		//open NoAllocationScopes of this thread
+		inline thread_local size_t no_allocation_depth = 0;
+	}
+
+	//marks a region, e.g. one frame, in which the containers and pools of the library must not allocate.
+	//checked with MYECS_ASSERT, so only debug builds report it. scopes nest
+	class NoAllocationScope {
+	public:
+		NoAllocationScope() {
+			internal::no_allocation_depth++;
+		}
+		~NoAllocationScope() {
+			internal::no_allocation_depth--;
+		}
+		NoAllocationScope(const NoAllocationScope&) = delete;
+		NoAllocationScope& operator=(const NoAllocationScope&) = delete;
+	};
+}
+
+//placed in front of every growth of a library container, will_allocate is only evaluated in debug builds
+#define MYECS_CHECK_ALLOCATION(will_allocate) \
+	MYECS_ASSERT(!(will_allocate) || ::myecs::internal::no_allocation_depth == 0, "allocation inside a NoAllocationScope")
+
 #endif
\ No newline at end of file
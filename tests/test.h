@@ -0,0 +1,17 @@
+#pragma once
+#ifndef MYECS_TEST_H
+#define MYECS_TEST_H
+
+#include<cstdio>
+#include<cstdlib>
+
+//assert that stays on in release builds, the tests run under every configuration
+#define MYECS_CHECK(...) \
+	do { \
+		if (!(__VA_ARGS__)) { \
+			std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #__VA_ARGS__); \
+			std::exit(1); \
+		} \
+	} while (false)
+
+#endif
@@ -0,0 +1,126 @@
+#include"test.h"
+#include"../src/entity.h"
+
+using namespace myecs;
+
+namespace {
+	struct Health {
+		int value;
+	};
+
+	//an entity listed twice gets one component and no storage slot is lost
+	void emplace_bulk_duplicates() {
+		Registry reg;
+		entity a = reg.create();
+		entity b = reg.create();
+		entity list[] = { a, b, a, a, b };
+		reg.emplace_bulk<Health>(list, 5, Health{ 7 });
+		MYECS_CHECK(reg.view<Health>().size() == 2);
+		PoolStats stats = reg.stats<Health>();
+		MYECS_CHECK(stats.count == 2);
+		reg.destroy(a);
+		reg.destroy(b);
+		MYECS_CHECK(reg.stats<Health>().count == 0);
+		MYECS_CHECK(reg.view<Health>().size() == 0);
+	}
+
+	//an entity already owning the component throws before any component set changes
+	void emplace_bulk_owned_throws() {
+		Registry reg;
+		entity a = reg.create();
+		entity b = reg.create();
+		reg.emplace<Health>(b, 1);
+		entity list[] = { a, b };
+		bool threw = false;
+		try {
+			reg.emplace_bulk<Health>(list, 2, Health{ 7 });
+		}
+		catch (const std::runtime_error&) {
+			threw = true;
+		}
+		MYECS_CHECK(threw);
+		MYECS_CHECK(!reg.has<Health>(a));
+		reg.destroy(a);
+		reg.destroy(b);
+		MYECS_CHECK(reg.stats<Health>().count == 0);
+	}
+
+	//the bulk destroy removes a chain and a subtree root from the hierarchy, children move up
+	void destroy_range_hierarchy() {
+		Registry reg;
+		std::vector<entity> es;
+		for (int i = 0; i < 8; i++) {
+			es.push_back(reg.create());
+		}
+		//0 <- 1 <- 2 <- 3, 0 <- 4 <- 5, 6 <- 7
+		reg.set_parent(es[1], es[0]);
+		reg.set_parent(es[2], es[1]);
+		reg.set_parent(es[3], es[2]);
+		reg.set_parent(es[4], es[0]);
+		reg.set_parent(es[5], es[4]);
+		reg.set_parent(es[7], es[6]);
+		entity dead[] = { es[1], es[2], es[4], es[6], es[6] };
+		reg.destroy(std::begin(dead), std::end(dead));
+		MYECS_CHECK(reg.parent(es[3]) == es[0]);
+		MYECS_CHECK(reg.parent(es[5]) == es[0]);
+		MYECS_CHECK(reg.parent(es[7]) == null_entity);
+		MYECS_CHECK(reg.entity_count() == 4);
+	}
+
+	struct A {
+		int value;
+	};
+
+	struct B {
+		int value;
+	};
+
+	struct C {
+		int value;
+	};
+
+	//bulk destroy and remove keep pools, persistent queries and indices in step
+	void destroy_range_components() {
+		Registry reg;
+		std::vector<entity> es;
+		(void)reg.persist<A, B>();
+		for (int i = 0; i < 1000; i++) {
+			entity e = reg.create();
+			es.push_back(e);
+			reg.emplace<A>(e, A{ i });
+			if (i % 2) {
+				reg.emplace<B>(e, B{ i });
+			}
+			if (i % 5 == 0) {
+				reg.emplace<C>(e, C{ i });
+			}
+		}
+		(void)reg.hash_index<&A::value>();
+		reg.set_parent(es[10], es[0]);
+		reg.destroy(es.begin(), es.begin() + 100);
+		MYECS_CHECK(reg.entity_count() == 900 && reg.view<A>().size() == 900);
+		MYECS_CHECK(reg.persistent_view<A, B>().size() == 450);
+		MYECS_CHECK(reg.find_by<&A::value>(5).size() == 0 && reg.find_by<&A::value>(500).size() == 1);
+		MYECS_CHECK(!reg.hierarchy().contains(es[10]));
+
+		reg.remove<B>(es.begin(), es.end());
+		MYECS_CHECK(reg.view<B>().size() == 0 && reg.persistent_view<A, B>().size() == 0 && !reg.has<B>(es[101]));
+		reg.destroy_all(reg.view<C>());
+		MYECS_CHECK(reg.view<C>().size() == 0 && reg.entity_count() == 900 - 180);
+		reg.destroy_all(reg.view<A>());
+		MYECS_CHECK(reg.entity_count() == 0 && reg.component_count() == 0);
+
+		entity e = reg.create();
+		reg.emplace<A>(e, A{ 3 });
+		reg.emplace<B>(e, B{ 3 });
+		MYECS_CHECK(reg.persistent_view<A, B>().size() == 1);
+	}
+}
+
+int main() {
+	emplace_bulk_duplicates();
+	destroy_range_components();
+	emplace_bulk_owned_throws();
+	destroy_range_hierarchy();
+	return 0;
+}
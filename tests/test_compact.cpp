@@ -0,0 +1,48 @@
+#ifndef MYECS_ENTITY_TRAITS
+#define MYECS_ENTITY_TRAITS ::myecs::compact_entity_traits
+#endif
+#include"test.h"
+#include"../src/entity.h"
+#include<stdexcept>
+
+using namespace myecs;
+
+namespace {
+	struct Position {
+		float x, y;
+	};
+
+	void handles_are_compact() {
+		static_assert(sizeof(entity) == 4);
+		Registry reg;
+		entity e = reg.create();
+		reg.emplace<Position>(e, Position{ 1, 2 });
+		reg.destroy(e);
+		entity again = reg.create();
+		MYECS_CHECK(again.get_id() == e.get_id() && again.get_version() == 1);
+		MYECS_CHECK(!reg.valid(e) && reg.valid(again));
+	}
+
+	//running out of ids throws in release builds too instead of wrapping into live handles
+	void out_of_ids_throws() {
+		IdGen<entity> ids;
+		for (size_t i = 0; i <= entity::traits_type::max_id; i++) {
+			(void)ids.get();
+		}
+		bool threw = false;
+		try {
+			(void)ids.get();
+		}
+		catch (const std::runtime_error&) {
+			threw = true;
+		}
+		MYECS_CHECK(threw);
+		MYECS_CHECK(ids.count() == entity::traits_type::max_id + 1);
+	}
+}
+
+int main() {
+	handles_are_compact();
+	out_of_ids_throws();
+	return 0;
+}
@@ -0,0 +1,81 @@
+#include"test.h"
+#include"../src/entity.h"
+#include<chrono>
+#include<vector>
+
+using namespace myecs;
+
+namespace {
+	struct A {
+		int value;
+	};
+
+	struct B {
+		int value;
+	};
+
+	//entities destroyed or losing B between frames are not visited later, every other match exactly once
+	void destroy_between_frames() {
+		Registry reg;
+		std::vector<entity> es;
+		for (int i = 0; i < 1000; i++) {
+			entity e = reg.create();
+			es.push_back(e);
+			reg.emplace<A>(e, A{ i });
+			if (i % 3) {
+				reg.emplace<B>(e, B{ i });
+			}
+		}
+		std::vector<int> seen(1000, 0);
+		ViewCursor<A, B> cursor;
+		size_t total = 0;
+		int frame = 0;
+		while (cursor.passes() == 0) {
+			total += reg.resume(cursor, CursorBudget{ 50 }, [&](entity, A& a, B& b) {
+				MYECS_CHECK(a.value == b.value);
+				seen[a.value]++;
+			});
+			//the last ids are not reached during the first frames, the low ones are
+			if (frame < 5) {
+				reg.destroy(es[998 - frame * 3]);
+				reg.destroy<B>(es[frame * 3 + 1]);
+			}
+			frame++;
+		}
+		size_t expected = 0;
+		for (int i = 0; i < 1000; i++) {
+			MYECS_CHECK(seen[i] <= 1);
+			bool skipped = false;
+			for (int f = 0; f < 5; f++) {
+				skipped = skipped || i == 998 - f * 3;
+			}
+			if (i % 3 && !skipped) {
+				//entities that lost B after the cursor passed them were still visited once
+				MYECS_CHECK(seen[i] == 1);
+			}
+			if (skipped) {
+				MYECS_CHECK(seen[i] == 0);
+			}
+			expected += seen[i];
+		}
+		MYECS_CHECK(total == expected);
+	}
+
+	//a time budget alone still finishes a small pass
+	void time_budget() {
+		Registry reg;
+		for (int i = 0; i < 100; i++) {
+			reg.emplace<A>(reg.create(), A{ i });
+		}
+		ViewCursor<A> cursor;
+		size_t n = reg.resume(cursor, CursorBudget{ 0, std::chrono::milliseconds(100) }, [](entity, A&) {});
+		MYECS_CHECK(n == 100);
+		MYECS_CHECK(cursor.passes() == 1);
+	}
+}
+
+int main() {
+	destroy_between_frames();
+	time_budget();
+	return 0;
+}
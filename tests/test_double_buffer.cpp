@@ -0,0 +1,70 @@
+#include"test.h"
+#include"../src/entity.h"
+#include<vector>
+
+using namespace myecs;
+
+namespace {
+	struct Cell {
+		float value;
+		int key;
+	};
+}
+
+template<> struct myecs::double_buffer_traits<Cell> :std::true_type {};
+
+namespace {
+	//reads through each(), gather(), current() and index upkeep leave the slots unmarked,
+	//so swap_buffers() copies exactly the slots written through get()
+	void only_writes_are_copied() {
+		Registry reg;
+		std::vector<entity> es;
+		for (int i = 0; i < 100; i++) {
+			entity e = reg.create();
+			es.push_back(e);
+			reg.emplace<Cell>(e, Cell{ float(i), i % 4 });
+		}
+		//emplace hands out the new slot, so it counts as a write
+		MYECS_CHECK(reg.stats<Cell>().written == 100);
+		reg.swap_buffers<Cell>();
+		(void)reg.hash_index<&Cell::key>();
+		MYECS_CHECK(reg.stats<Cell>().written == 0);
+
+		float sum = 0;
+		reg.each<Cell>([&](entity, const Cell& cell) {
+			sum += cell.value;
+		});
+		MYECS_CHECK(sum == 4950);
+		std::vector<Cell> out(es.size());
+		reg.gather<Cell>(es, out.data());
+		MYECS_CHECK(out[7].value == 7);
+		MYECS_CHECK(reg.current<Cell>(es[8]).value == 8);
+		MYECS_CHECK(reg.stats<Cell>().written == 0);
+
+		//each cell takes the mean of its neighbours' previous values
+		for (size_t i = 1; i + 1 < es.size(); i++) {
+			reg.get<Cell>(es[i]).value = 0.5f * (reg.previous<Cell>(es[i - 1]).value + reg.previous<Cell>(es[i + 1]).value);
+		}
+		MYECS_CHECK(reg.stats<Cell>().written == 98);
+		MYECS_CHECK(reg.previous<Cell>(es[5]).value == 5 && reg.current<Cell>(es[5]).value == 5);
+		reg.get<Cell>(es[5]).value = 50;
+		MYECS_CHECK(reg.previous<Cell>(es[5]).value == 5 && reg.current<Cell>(es[5]).value == 50);
+
+		reg.swap_buffers<Cell>();
+		MYECS_CHECK(reg.stats<Cell>().written == 0);
+		MYECS_CHECK(reg.previous<Cell>(es[5]).value == 50 && reg.current<Cell>(es[5]).value == 50);
+		MYECS_CHECK(reg.previous<Cell>(es[0]).value == 0 && reg.current<Cell>(es[99]).value == 99);
+
+		//patch writes
+		reg.patch<Cell>(es[3], [](Cell& cell) {
+			cell.key = 9;
+		});
+		MYECS_CHECK(reg.stats<Cell>().written == 1);
+		MYECS_CHECK(reg.find_by<&Cell::key>(9).size() == 1);
+	}
+}
+
+int main() {
+	only_writes_are_copied();
+	return 0;
+}
@@ -0,0 +1,128 @@
+#include"test.h"
+#include"../src/entity.h"
+#include<algorithm>
+
+using namespace myecs;
+
+namespace {
+	struct Random {
+		types::u64 state = 0x9E3779B97F4A7C15ull;
+
+		size_t operator()(size_t n) {
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			return static_cast<size_t>(state % n);
+		}
+	};
+
+	//parents, subtree runs and positions all agree
+	void check_consistent(const Hierarchy& h) {
+		std::span<const entity> order = h.order();
+		for (size_t i = 0; i < order.size(); i++) {
+			MYECS_CHECK(h.contains(order[i]));
+			std::span<const entity> sub = h.subtree(order[i]);
+			MYECS_CHECK(sub.data() == order.data() + i);
+			size_t p = h.parent_index(i);
+			if (p == Hierarchy::npos) {
+				MYECS_CHECK(h.parent(order[i]) == null_entity);
+				continue;
+			}
+			MYECS_CHECK(p < i);
+			MYECS_CHECK(order[p] == h.parent(order[i]));
+			std::span<const entity> parent_sub = h.subtree(order[p]);
+			MYECS_CHECK(i + sub.size() <= p + parent_sub.size());
+		}
+	}
+
+	//erase_bulk leaves the same order and parents as erasing the entities one by one
+	void bulk_matches_single(size_t n, size_t removed, size_t seed) {
+		Random random{ 0x9E3779B97F4A7C15ull + seed };
+		std::vector<entity> all;
+		Hierarchy single;
+		Hierarchy bulk;
+		for (size_t i = 0; i < n; i++) {
+			all.push_back(entity(i, 0));
+			entity parent = i && random(4) ? all[random(i)] : null_entity;
+			single.set_parent(all[i], parent);
+			bulk.set_parent(all[i], parent);
+		}
+		std::vector<entity> dead;
+		for (size_t i = 0; i < removed; i++) {
+			dead.push_back(all[random(n)]);
+		}
+		dead.push_back(entity(n + 5, 0));
+		for (entity e : dead) {
+			single.erase(e);
+		}
+		bulk.erase_bulk(dead);
+		check_consistent(bulk);
+		MYECS_CHECK(bulk.size() == single.size());
+		for (size_t i = 0; i < bulk.size(); i++) {
+			MYECS_CHECK(bulk.order()[i] == single.order()[i]);
+			MYECS_CHECK(bulk.parent(bulk.order()[i]) == single.parent(single.order()[i]));
+			MYECS_CHECK(bulk.subtree(bulk.order()[i]).size() == single.subtree(single.order()[i]).size());
+		}
+		for (entity e : dead) {
+			MYECS_CHECK(!bulk.contains(e));
+		}
+	}
+
+	struct Transform {
+		float local, world;
+	};
+
+	//random reparenting, cycles refused and destroyed entities replaced, then a propagate pass
+	//gives every node the sum of the locals on its path to the root
+	void reparent_and_propagate() {
+		Random random;
+		Registry reg;
+		std::vector<entity> es;
+		for (int i = 0; i < 300; i++) {
+			entity e = reg.create();
+			es.push_back(e);
+			reg.emplace<Transform>(e, Transform{ float(i), 0 });
+		}
+		for (int step = 0; step < 20000; step++) {
+			entity e = es[random(es.size())];
+			size_t r = random(10);
+			if (r == 0) {
+				reg.destroy(e);
+				es.erase(std::find(es.begin(), es.end(), e));
+				entity created = reg.create();
+				es.push_back(created);
+				reg.emplace<Transform>(created, Transform{ 1, 0 });
+				continue;
+			}
+			entity parent = r == 1 ? null_entity : es[random(es.size())];
+			try {
+				reg.set_parent(e, parent);
+			}
+			catch (const std::runtime_error&) {
+				//parent lies in the subtree of e
+			}
+		}
+		const Hierarchy& h = reg.hierarchy();
+		check_consistent(h);
+		reg.propagate<Transform>([](const Transform* parent, Transform& node) {
+			node.world = node.local + (parent ? parent->world : 0);
+		});
+		for (entity e : h.order()) {
+			float world = 0;
+			for (entity a = e; a != null_entity; a = h.parent(a)) {
+				world += reg.get<Transform>(a).local;
+			}
+			MYECS_CHECK(world == reg.get<Transform>(e).world);
+		}
+	}
+}
+
+int main() {
+	for (size_t seed = 0; seed < 20; seed++) {
+		bulk_matches_single(200, seed * 10, seed);
+	}
+	bulk_matches_single(50, 50, 99);
+	bulk_matches_single(1, 1, 7);
+	reparent_and_propagate();
+	return 0;
+}
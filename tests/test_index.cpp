@@ -0,0 +1,176 @@
+#include"test.h"
+#include"../src/entity.h"
+#include<algorithm>
+
+using namespace myecs;
+
+namespace {
+	struct Owner {
+		int player;
+	};
+
+	//a key without a default constructor
+	struct Team {
+		explicit Team(int id) :id(id) {}
+		int id;
+		bool operator==(const Team&)const = default;
+		bool operator<(const Team& other)const {
+			return id < other.id;
+		}
+	};
+
+	struct Member {
+		Team team;
+	};
+}
+
+template<>
+struct std::hash<Team> {
+	size_t operator()(const Team& team)const {
+		return std::hash<int>{}(team.id);
+	}
+};
+
+namespace {
+	bool contains(std::span<const entity> list, entity e) {
+		return std::find(list.begin(), list.end(), e) != list.end();
+	}
+
+	bool contains(const IntVector<entity>& list, entity e) {
+		return std::find(list.begin(), list.end(), e) != list.end();
+	}
+
+	//fields written through get() and then destroyed must leave the index as if patch() was never skipped
+	void changed_through_get_then_destroyed() {
+		Registry reg;
+		std::vector<entity> es;
+		for (int i = 0; i < 64; i++) {
+			entity e = reg.create();
+			reg.emplace<Owner>(e, i % 4);
+			es.push_back(e);
+		}
+		HashIndex<&Owner::player>& hash = reg.hash_index<&Owner::player>();
+		OrderedIndex<&Owner::player>& ordered = reg.ordered_index<&Owner::player>();
+
+		//entity 0 is filed under player 0, its field now says 3
+		reg.get<Owner>(es[0]).player = 3;
+		reg.destroy(es[0]);
+		MYECS_CHECK(!contains(hash.find(0), es[0]));
+		MYECS_CHECK(!contains(hash.find(3), es[0]));
+		MYECS_CHECK(hash.count(0) == 15);
+		MYECS_CHECK(hash.count(3) == 16);
+		MYECS_CHECK(!contains(ordered.find(0, 3), es[0]));
+		MYECS_CHECK(ordered.size() == 63);
+
+		//everything filed under 2 moves to a key no bucket holds before it dies
+		for (int i = 2; i < 64; i += 4) {
+			reg.get<Owner>(es[i]).player = 100;
+		}
+		for (int i = 2; i < 64; i += 4) {
+			reg.destroy(es[i]);
+		}
+		MYECS_CHECK(hash.count(2) == 0);
+		MYECS_CHECK(hash.count(100) == 0);
+		MYECS_CHECK(hash.key_count() == 3);
+		MYECS_CHECK(ordered.size() == 47);
+
+		//every live entity is found exactly under the key it was filed with
+		for (int i = 1; i < 64; i++) {
+			if (!reg.valid(es[i])) {
+				continue;
+			}
+			MYECS_CHECK(contains(hash.find(i % 4), es[i]));
+			MYECS_CHECK(contains(ordered.find(i % 4, i % 4), es[i]));
+		}
+		size_t total = 0;
+		for (int key = 0; key < 4; key++) {
+			total += hash.count(key);
+		}
+		MYECS_CHECK(total == 47);
+	}
+
+	//patch after a write through get() moves the entity from its filed key to the new one
+	void patch_after_write_through_get() {
+		Registry reg;
+		entity a = reg.create();
+		entity b = reg.create();
+		reg.emplace<Owner>(a, 1);
+		reg.emplace<Owner>(b, 1);
+		HashIndex<&Owner::player>& hash = reg.hash_index<&Owner::player>();
+		OrderedIndex<&Owner::player>& ordered = reg.ordered_index<&Owner::player>();
+		reg.get<Owner>(a).player = 5;
+		reg.patch<Owner>(a, [](Owner& o) {
+			o.player = 7;
+		});
+		MYECS_CHECK(hash.count(1) == 1 && contains(hash.find(1), b));
+		MYECS_CHECK(hash.count(5) == 0);
+		MYECS_CHECK(contains(hash.find(7), a));
+		MYECS_CHECK(ordered.find(7, 7).size() == 1);
+		MYECS_CHECK(ordered.size() == 2);
+		reg.destroy(a);
+		reg.destroy(b);
+		MYECS_CHECK(hash.key_count() == 0);
+		MYECS_CHECK(ordered.size() == 0);
+	}
+
+	//lookups follow destroy, patch and component removal, dropping one index keeps the other
+	void lookups() {
+		Registry reg;
+		std::vector<entity> es;
+		for (int i = 0; i < 100; i++) {
+			entity e = reg.create();
+			es.push_back(e);
+			reg.emplace<Owner>(e, Owner{ i % 10 });
+		}
+		MYECS_CHECK(reg.find_by<&Owner::player>(3).size() == 10);
+		reg.destroy(es[3]);
+		MYECS_CHECK(reg.find_by<&Owner::player>(3).size() == 9);
+		reg.patch<Owner>(es[13], [](Owner& o) {
+			o.player = 42;
+		});
+		MYECS_CHECK(reg.find_by<&Owner::player>(3).size() == 8);
+		MYECS_CHECK(reg.find_by<&Owner::player>(42).size() == 1 && reg.find_by<&Owner::player>(42)[0] == es[13]);
+		MYECS_CHECK(reg.find_range<&Owner::player>(5, 9).size() == 50);
+		entity e = reg.create();
+		reg.emplace<Owner>(e, Owner{ 7 });
+		MYECS_CHECK(reg.find_range<&Owner::player>(5, 9).size() == 51);
+		reg.destroy<Owner>(e);
+		MYECS_CHECK(reg.find_range<&Owner::player>(5, 9).size() == 50);
+		reg.drop_index<&Owner::player, HashIndex>();
+		MYECS_CHECK(reg.find_by<&Owner::player>(42).size() == 1);
+		reg.reset();
+		MYECS_CHECK(reg.find_by<&Owner::player>(42).size() == 0);
+	}
+
+	//keys that can not be default constructed are indexed, and erased entities leave no key behind
+	void key_without_default_constructor() {
+		Registry reg;
+		std::vector<entity> es;
+		for (int i = 0; i < 32; i++) {
+			entity e = reg.create();
+			reg.emplace<Member>(e, Member{ Team(i % 2) });
+			es.push_back(e);
+		}
+		HashIndex<&Member::team>& hash = reg.hash_index<&Member::team>();
+		OrderedIndex<&Member::team>& ordered = reg.ordered_index<&Member::team>();
+		MYECS_CHECK(hash.count(Team(0)) == 16 && hash.count(Team(1)) == 16);
+		for (int i = 0; i < 32; i += 2) {
+			reg.destroy(es[i]);
+		}
+		MYECS_CHECK(hash.count(Team(0)) == 0 && hash.key_count() == 1);
+		MYECS_CHECK(ordered.find(Team(0), Team(1)).size() == 16);
+		//the freed ids are reused under a new key
+		for (int i = 0; i < 16; i++) {
+			reg.emplace<Member>(reg.create(), Member{ Team(2) });
+		}
+		MYECS_CHECK(hash.count(Team(2)) == 16 && hash.count(Team(1)) == 16);
+	}
+}
+
+int main() {
+	changed_through_get_then_destroyed();
+	patch_after_write_through_get();
+	lookups();
+	key_without_default_constructor();
+	return 0;
+}
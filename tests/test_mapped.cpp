@@ -0,0 +1,194 @@
+#include"test.h"
+#include"../src/mapped_registry.h"
+#include<cstdio>
+#include<filesystem>
+#include<fstream>
+#include<map>
+#include<stdexcept>
+#include<vector>
+
+using namespace myecs;
+
+namespace {
+	struct Position {
+		float x, y;
+	};
+
+	struct Velocity {
+		float dx, dy;
+	};
+
+	struct Tag {
+		int id;
+	};
+
+	using World = MappedRegistry<Position, Velocity, Tag>;
+
+	std::filesystem::path temp_file(const char* name) {
+		std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+		std::filesystem::remove(path);
+		return path;
+	}
+
+	template<class Func>
+	bool throws(Func&& func) {
+		try {
+			func();
+		}
+		catch (const std::runtime_error&) {
+			return true;
+		}
+		return false;
+	}
+
+	//what the test expects of every live entity
+	struct Expected {
+		int id;
+		bool has_velocity;
+	};
+
+	void check(World& world, const std::vector<std::pair<entity, Expected>>& live) {
+		MYECS_CHECK(world.entity_count() == live.size());
+		size_t velocities = 0;
+		for (const auto& [e, x] : live) {
+			MYECS_CHECK(world.valid(e));
+			MYECS_CHECK(world.get<Tag>(e).id == x.id);
+			MYECS_CHECK(world.get<Position>(e).x == float(x.id) && world.get<Position>(e).y == -float(x.id));
+			MYECS_CHECK(world.has<Velocity>(e) == x.has_velocity);
+			if (x.has_velocity) {
+				MYECS_CHECK(world.get<Velocity>(e).dx == 2.f * float(x.id));
+				velocities++;
+			}
+		}
+		size_t visited = 0;
+		world.each<Position, Velocity>([&](entity, Position& p, Velocity& v) {
+			MYECS_CHECK(v.dx == 2.f * p.x);
+			visited++;
+		});
+		MYECS_CHECK(visited == velocities && world.size<Velocity>() == velocities);
+	}
+
+	//create past the initial capacity, destroy some, close, reopen: everything reads back the same
+	void round_trip() {
+		std::filesystem::path path = temp_file("myecs_test_mapped_round_trip.bin");
+		std::vector<std::pair<entity, Expected>> live;
+		std::vector<entity> dead;
+		{
+			World world(path);
+			size_t initial = world.capacity();
+			//values written before every grow() must survive the move of the arrays
+			for (int i = 0; i < 1000; i++) {
+				entity e = world.create();
+				world.emplace<Position>(e, Position{ float(i), -float(i) });
+				world.emplace<Tag>(e, Tag{ i });
+				if (i % 3) {
+					world.emplace<Velocity>(e, Velocity{ 2.f * float(i), 0.f });
+				}
+				live.push_back({ e, Expected{ i, i % 3 != 0 } });
+			}
+			MYECS_CHECK(world.capacity() > initial);
+			check(world, live);
+
+			std::vector<std::pair<entity, Expected>> kept;
+			for (auto& [e, x] : live) {
+				if (x.id % 5 == 0) {
+					world.destroy(e);
+					dead.push_back(e);
+				}
+				else {
+					if (x.id % 7 == 0 && x.has_velocity) {
+						world.destroy<Velocity>(e);
+						x.has_velocity = false;
+					}
+					kept.push_back({ e, x });
+				}
+			}
+			live = kept;
+			check(world, live);
+			world.flush();
+		}
+		{
+			World world(path);
+			check(world, live);
+			for (entity e : dead) {
+				MYECS_CHECK(!world.valid(e));
+			}
+			//a freed id comes back with the next version
+			entity e = world.create();
+			bool reused = false;
+			for (entity d : dead) {
+				reused = reused || (d.get_id() == e.get_id() && d.get_version() + 1 == e.get_version());
+			}
+			MYECS_CHECK(reused);
+			world.emplace<Position>(e, Position{ 5000.f, -5000.f });
+			world.emplace<Tag>(e, Tag{ 5000 });
+			live.push_back({ e, Expected{ 5000, false } });
+			check(world, live);
+		}
+		{
+			World world(path);
+			check(world, live);
+		}
+		std::filesystem::remove(path);
+	}
+
+	//files of another component list, another format version, cut short or of another kind are refused
+	void rejects_foreign_files() {
+		std::filesystem::path path = temp_file("myecs_test_mapped_reject.bin");
+		{
+			World world(path);
+			entity e = world.create();
+			world.emplace<Tag>(e, Tag{ 1 });
+		}
+		MYECS_CHECK(throws([&] {
+			MappedRegistry<Position, Velocity> other(path);
+		}));
+		MYECS_CHECK(throws([&] {
+			MappedRegistry<Position, Tag, Velocity> other(path);
+		}));
+		{
+			World world(path);
+			MYECS_CHECK(world.entity_count() == 1);
+		}
+
+		//the format version follows the 8 byte magic
+		std::filesystem::path copy = temp_file("myecs_test_mapped_version.bin");
+		std::filesystem::copy_file(path, copy);
+		{
+			std::fstream f(copy, std::ios::in | std::ios::out | std::ios::binary);
+			f.seekp(8);
+			types::u32 version = World::format_version + 1;
+			f.write(reinterpret_cast<const char*>(&version), sizeof(version));
+		}
+		MYECS_CHECK(throws([&] {
+			World world(copy);
+		}));
+		std::filesystem::remove(copy);
+
+		std::filesystem::resize_file(path, std::filesystem::file_size(path) / 2);
+		MYECS_CHECK(throws([&] {
+			World world(path);
+		}));
+		std::filesystem::resize_file(path, 4);
+		MYECS_CHECK(throws([&] {
+			World world(path);
+		}));
+		std::filesystem::remove(path);
+
+		{
+			std::ofstream f(path, std::ios::binary);
+			std::vector<char> text(4096, 'x');
+			f.write(text.data(), text.size());
+		}
+		MYECS_CHECK(throws([&] {
+			World world(path);
+		}));
+		std::filesystem::remove(path);
+	}
+}
+
+int main() {
+	round_trip();
+	rejects_foreign_files();
+	return 0;
+}
@@ -0,0 +1,71 @@
+#include"test.h"
+#include"../src/entity.h"
+#include<string>
+
+using namespace myecs;
+
+namespace {
+	struct A {
+		int value;
+	};
+
+	struct B {
+		std::string name;
+	};
+
+	struct S {
+		float x, y;
+	};
+}
+
+template<> struct myecs::soa_traits<S> :soa_layout<&S::x, &S::y> {};
+
+namespace {
+	//every instance gets a copy of each value, soa components and indices included
+	void instantiate_copies() {
+		Registry reg;
+		//a freed id is reused by the first instance
+		entity old = reg.create();
+		reg.emplace<A>(old, A{ 1 });
+		reg.destroy(old);
+		(void)reg.persist<A, B>();
+		(void)reg.hash_index<&A::value>();
+
+		Prefab prefab;
+		prefab.set<A>(A{ 5 }).set<B>(B{ "hello" }).set<S>(S{ 1, 2 });
+		IntVector<entity> es = reg.instantiate(prefab, 100);
+		MYECS_CHECK(es.size() == 100);
+		for (entity e : es) {
+			MYECS_CHECK(reg.get<A>(e).value == 5);
+			MYECS_CHECK(reg.get<B>(e).name == "hello");
+			MYECS_CHECK(reg.get<S>(e).get<&S::y>() == 2);
+		}
+		MYECS_CHECK(reg.persistent_view<A, B>().size() == 100);
+		MYECS_CHECK(reg.find_by<&A::value>(5).size() == 100);
+
+		reg.destroy(es[3]);
+		entity one = reg.instantiate(prefab);
+		MYECS_CHECK(reg.get<B>(one).name == "hello");
+		MYECS_CHECK(reg.view<A, B>().size() == 100);
+		(void)reg.instantiate(prefab, 50);
+		MYECS_CHECK(reg.find_by<&A::value>(5).size() == 150);
+	}
+
+	//set replaces a value, remove drops the component for later instances
+	void edit_prefab() {
+		Prefab prefab;
+		prefab.set<A>(A{ 1 }).set<A>(A{ 2 }).set<B>(B{ "x" });
+		MYECS_CHECK(prefab.size() == 2 && prefab.get<A>().value == 2);
+		prefab.remove<B>();
+		MYECS_CHECK(!prefab.has<B>());
+		Registry reg;
+		entity e = reg.instantiate(prefab);
+		MYECS_CHECK(reg.get<A>(e).value == 2 && !reg.has<B>(e));
+	}
+}
+
+int main() {
+	instantiate_copies();
+	edit_prefab();
+	return 0;
+}
@@ -0,0 +1,75 @@
+#include"test.h"
+#include"../src/entity.h"
+#include<vector>
+
+using namespace myecs;
+
+namespace {
+	struct A {
+		int value;
+	};
+
+	struct B {
+		int value;
+	};
+
+	struct C {};
+
+	//a persistent query follows every emplace and destroy of its components
+	void persistent_matches() {
+		Registry reg;
+		std::vector<entity> es;
+		for (int i = 0; i < 100; i++) {
+			entity e = reg.create();
+			es.push_back(e);
+			reg.emplace<A>(e, A{ i });
+			if (i % 2) {
+				reg.emplace<B>(e, B{ i });
+			}
+		}
+		MYECS_CHECK(reg.persistent_view<A, B>().size() == 50);
+		reg.emplace<B>(es[0], B{ 0 });
+		MYECS_CHECK(reg.persistent_view<A, B>().size() == 51);
+		reg.destroy<A>(es[1]);
+		MYECS_CHECK(reg.persistent_view<A, B>().size() == 50);
+		reg.destroy(es[3]);
+		MYECS_CHECK(reg.persistent_view<A, B>().size() == 49);
+		entity e = reg.create();
+		reg.emplace<B>(e, B{ 1 });
+		MYECS_CHECK(reg.persistent_view<A, B>().size() == 49);
+		reg.emplace<A>(e, A{ 1 });
+		MYECS_CHECK(reg.persistent_view<A, B>().size() == 50);
+		//components outside the query change nothing
+		reg.emplace<C>(e);
+		MYECS_CHECK(reg.persistent_view<A, B>().size() == 50);
+
+		size_t n = 0;
+		reg.each<A, B>([&](entity, A&, B&) {
+			n++;
+		});
+		MYECS_CHECK(n == 50);
+		MYECS_CHECK(reg.view<A, B>().size() == 50);
+		PersistentQueryStats stats = reg.query_stats<A, B>();
+		MYECS_CHECK(stats.reads > 0 && stats.inserts > 0 && stats.erases > 0);
+
+		reg.reset();
+		MYECS_CHECK(reg.persistent_view<A, B>().size() == 0);
+	}
+
+	//registered queries move with the registry
+	void moved_registry() {
+		Registry reg;
+		(void)reg.persist<A, B>();
+		Registry other(std::move(reg));
+		entity e = other.create();
+		other.emplace<A>(e, A{ 1 });
+		other.emplace<B>(e, B{ 1 });
+		MYECS_CHECK(other.persistent_view<A, B>().size() == 1);
+	}
+}
+
+int main() {
+	persistent_matches();
+	moved_registry();
+	return 0;
+}
@@ -0,0 +1,127 @@
+#include"test.h"
+#include"../src/entity.h"
+#include<chrono>
+#include<map>
+#include<vector>
+
+using namespace myecs;
+
+namespace {
+	struct A {
+		int value;
+	};
+
+	struct B {
+		int value;
+	};
+
+	struct Expected {
+		int value;
+		bool has_b;
+		entity parent;
+	};
+
+	//components, parents, indices and each() all agree with what the test kept on the side
+	void check(Registry& reg, const std::map<entity, Expected, bool(*)(entity, entity)>& expected) {
+		MYECS_CHECK(reg.entity_count() == expected.size());
+		size_t with_b = 0;
+		for (const auto& [e, x] : expected) {
+			MYECS_CHECK(reg.valid(e));
+			MYECS_CHECK(reg.get<A>(e).value == x.value);
+			MYECS_CHECK(reg.has<B>(e) == x.has_b);
+			if (x.has_b) {
+				MYECS_CHECK(reg.get<B>(e).value == -x.value);
+				with_b++;
+			}
+			MYECS_CHECK(reg.parent(e) == x.parent);
+			std::span<const entity> found = reg.find_by<&A::value>(x.value);
+			MYECS_CHECK(found.size() == 1 && found[0] == e);
+		}
+		size_t visited = 0;
+		reg.each<A, B>([&](entity e, A& a, B& b) {
+			auto it = expected.find(e);
+			MYECS_CHECK(it != expected.end() && it->second.has_b);
+			MYECS_CHECK(a.value == it->second.value && b.value == -a.value);
+			visited++;
+		});
+		MYECS_CHECK(visited == with_b);
+		MYECS_CHECK(reg.persistent_view<A, B>().size() == with_b);
+	}
+
+	bool by_handle(entity a, entity b) {
+		return a._entity < b._entity;
+	}
+
+	//after a spike and a mass destroy, an incremental compact and a renumber keep every value in place
+	void compact_then_renumber() {
+		Registry reg;
+		(void)reg.persist<A, B>();
+		(void)reg.hash_index<&A::value>();
+		std::vector<entity> es;
+		for (int i = 0; i < 2000; i++) {
+			entity e = reg.create();
+			es.push_back(e);
+			reg.emplace<A>(e, A{ i });
+			if (i % 3) {
+				reg.emplace<B>(e, B{ -i });
+			}
+		}
+		for (int i = 1; i < 2000; i++) {
+			if (i % 7) {
+				reg.set_parent(es[i], es[i / 7 * 7]);
+			}
+		}
+		//three quarters die, survivors are spread over the whole id range
+		std::vector<entity> dead;
+		for (int i = 0; i < 2000; i++) {
+			if (i % 4) {
+				dead.push_back(es[i]);
+			}
+		}
+		reg.destroy(dead.begin(), dead.end());
+		std::map<entity, Expected, bool(*)(entity, entity)> expected(by_handle);
+		for (int i = 0; i < 2000; i += 4) {
+			entity parent = reg.parent(es[i]);
+			expected[es[i]] = Expected{ i, i % 3 != 0, parent };
+		}
+		check(reg, expected);
+
+		size_t calls = 1;
+		while (!reg.compact(std::chrono::nanoseconds(1))) {
+			calls++;
+		}
+		MYECS_CHECK(calls > 1);
+		check(reg, expected);
+
+		std::map<entity, entity, bool(*)(entity, entity)> renamed(by_handle);
+		reg.renumber([&](entity old, entity now) {
+			renamed[old] = now;
+		});
+		MYECS_CHECK(!renamed.empty());
+		auto rename = [&](entity e) {
+			auto it = renamed.find(e);
+			return it == renamed.end() ? e : it->second;
+		};
+		std::map<entity, Expected, bool(*)(entity, entity)> after(by_handle);
+		for (const auto& [e, x] : expected) {
+			entity now = rename(e);
+			MYECS_CHECK(now.get_id() < expected.size());
+			after[now] = Expected{ x.value, x.has_b, x.parent == null_entity ? null_entity : rename(x.parent) };
+		}
+		check(reg, after);
+		MYECS_CHECK(reg.stats().max_entity_count == after.size());
+
+		//the packed registry keeps working
+		entity e = reg.create();
+		MYECS_CHECK(e.get_id() == after.size());
+		reg.emplace<A>(e, A{ 5000 });
+		reg.emplace<B>(e, B{ -5000 });
+		after[e] = Expected{ 5000, true, null_entity };
+		check(reg, after);
+	}
+}
+
+int main() {
+	compact_then_renumber();
+	return 0;
+}
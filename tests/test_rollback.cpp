@@ -0,0 +1,115 @@
+#include"test.h"
+#include"../src/entity.h"
+#include<stdexcept>
+
+using namespace myecs;
+
+namespace {
+	struct A {
+		int value;
+	};
+
+	struct B {
+		int value;
+	};
+
+	template<class Func>
+	bool throws(Func&& func) {
+		try {
+			func();
+		}
+		catch (const std::exception&) {
+			return true;
+		}
+		return false;
+	}
+
+	//a create that throws must not leave the entity in persistent queries or its component set
+	void emplace_past_fixed_growth() {
+		Registry reg;
+		reg.set_growth<A>(GrowthPolicy::fixed(2));
+		reg.persist<A, B>();
+		entity es[3];
+		for (int i = 0; i < 3; i++) {
+			es[i] = reg.create();
+			reg.emplace<B>(es[i], B{ i });
+		}
+		reg.emplace<A>(es[0], A{ 0 });
+		reg.emplace<A>(es[1], A{ 1 });
+		MYECS_CHECK(throws([&] {
+			reg.emplace<A>(es[2], A{ 2 });
+		}));
+		MYECS_CHECK(!reg.has<A>(es[2]));
+		MYECS_CHECK(reg.persistent_view<A, B>().size() == 2);
+		int visited = 0;
+		reg.each<A, B>([&](entity, A& a, B& b) {
+			MYECS_CHECK(a.value == b.value);
+			visited++;
+		});
+		MYECS_CHECK(visited == 2);
+		//the entity still dies cleanly and owns nothing of A
+		reg.destroy(es[2]);
+		MYECS_CHECK(reg.persistent_view<A, B>().size() == 2);
+	}
+
+	//a runtime component whose constructor throws is neither stored nor listed for the entity
+	void runtime_emplace_throws() {
+		Registry reg;
+		pool::TypeInfo info = pool::TypeInfo::of<A>();
+		info.construct = [](void*) {
+			throw std::runtime_error("no default value");
+		};
+		id_type cid = reg.add_component(std::move(info));
+		entity e = reg.create();
+		MYECS_CHECK(throws([&] {
+			reg.emplace(e, cid);
+		}));
+		MYECS_CHECK(!reg.has(e, cid));
+		MYECS_CHECK(reg.view(cid).size() == 0);
+		MYECS_CHECK(reg.component_count() == 0);
+		//the entity can still get the component from a value
+		A value{ 4 };
+		reg.emplace(e, cid, &value);
+		MYECS_CHECK(static_cast<A*>(reg.get(e, cid))->value == 4);
+		reg.destroy(e);
+		MYECS_CHECK(reg.component_count() == 0);
+	}
+
+	//a prefab whose second component can not be stamped leaves no entities behind
+	void instantiate_past_fixed_growth() {
+		Registry reg;
+		reg.set_growth<B>(GrowthPolicy::fixed(4));
+		reg.persist<A, B>();
+		entity kept = reg.create();
+		reg.emplace<A>(kept, A{ 7 });
+		reg.emplace<B>(kept, B{ 7 });
+		Prefab prefab;
+		prefab.set<A>(A{ 1 }).set<B>(B{ 1 });
+		size_t alive = reg.entity_count();
+		MYECS_CHECK(throws([&] {
+			(void)reg.instantiate(prefab, 8);
+		}));
+		MYECS_CHECK(reg.entity_count() == alive);
+		MYECS_CHECK(reg.view<A>().size() == 1 && reg.view<B>().size() == 1);
+		MYECS_CHECK(reg.persistent_view<A, B>().size() == 1);
+		int visited = 0;
+		reg.each<A, B>([&](entity e, A& a, B& b) {
+			MYECS_CHECK(e == kept && a.value == 7 && b.value == 7);
+			visited++;
+		});
+		MYECS_CHECK(visited == 1);
+		//the released ids come back without stale components
+		IntVector<entity> made = reg.instantiate(prefab, 3);
+		for (entity e : made) {
+			MYECS_CHECK(reg.get<A>(e).value == 1 && reg.get<B>(e).value == 1);
+		}
+		MYECS_CHECK(reg.persistent_view<A, B>().size() == 4);
+	}
+}
+
+int main() {
+	emplace_past_fixed_growth();
+	runtime_emplace_throws();
+	instantiate_past_fixed_growth();
+	return 0;
+}
@@ -0,0 +1,57 @@
+#include"test.h"
+#include"../src/static_registry.h"
+#include<vector>
+
+using namespace myecs;
+
+namespace {
+	struct A {
+		int value;
+	};
+
+	struct B {
+		int value;
+	};
+
+	struct C {
+		int value;
+	};
+
+	void components_and_views() {
+		using Reg = StaticRegistry<A, B, C>;
+		static_assert(Reg::index_of<C> == 2);
+		Reg reg;
+		std::vector<entity> es;
+		for (int i = 0; i < 100; i++) {
+			entity e = reg.create();
+			es.push_back(e);
+			reg.emplace<A>(e, A{ i });
+			if (i % 2) {
+				reg.emplace<B>(e, B{ i });
+			}
+		}
+		MYECS_CHECK(reg.view<A, B>().size() == 50);
+		MYECS_CHECK(reg.has<A, B>(es[1]) && !reg.has<B>(es[0]));
+		size_t n = 0;
+		reg.each<A, B>([&](entity, A& a, B& b) {
+			n += a.value == b.value;
+		});
+		MYECS_CHECK(n == 50);
+
+		reg.destroy(es[1]);
+		MYECS_CHECK(reg.view<A, B>().size() == 49 && !reg.valid(es[1]) && !reg.has<A>(es[1]));
+		reg.destroy<B>(es[3]);
+		MYECS_CHECK(reg.view<A, B>().size() == 48 && reg.has<A>(es[3]));
+		auto [a, b] = reg.get<A, B>(es[5]);
+		MYECS_CHECK(a.value == 5 && b.value == 5);
+		MYECS_CHECK(reg.try_get<B>(es[0]) == nullptr);
+		MYECS_CHECK(reg.component_count() == 99 + 48);
+		reg.reset();
+		MYECS_CHECK(reg.component_count() == 0);
+	}
+}
+
+int main() {
+	components_and_views();
+	return 0;
+}
@@ -0,0 +1,107 @@
+#include"test.h"
+#include"../src/entity.h"
+#include<vector>
+
+using namespace myecs;
+
+namespace {
+	struct Health {
+		int value;
+	};
+
+	//with in_place deletion each<T> may destroy entities and remove T, visited or not:
+	//the ones removed before their turn are skipped, every other entity is visited once
+	void destroy_inside_each() {
+		Registry reg;
+		reg.set_deletion<Health>(DeletionPolicy::in_place());
+		std::vector<entity> es;
+		for (int i = 0; i < 1000; i++) {
+			entity e = reg.create();
+			es.push_back(e);
+			reg.emplace<Health>(e, Health{ i });
+		}
+		std::vector<int> visits(1000, 0);
+		reg.each<Health>([&](entity e, Health& health) {
+			int i = health.value;
+			MYECS_CHECK(es[i] == e);
+			visits[i]++;
+			if (i % 8 == 0) {
+				//itself, already visited
+				reg.destroy(e);
+			}
+			else if (i % 8 == 1) {
+				//the next one, not visited yet
+				reg.destroy(es[i + 1]);
+			}
+			else if (i % 8 == 3) {
+				//a later one loses only the component
+				reg.destroy<Health>(es[i + 2]);
+			}
+		});
+		size_t live = 0;
+		for (int i = 0; i < 1000; i++) {
+			bool skipped = i % 8 == 2 || i % 8 == 5;
+			MYECS_CHECK(visits[i] == (skipped ? 0 : 1));
+			if (reg.has<Health>(es[i])) {
+				MYECS_CHECK(reg.get<Health>(es[i]).value == i);
+				live++;
+			}
+		}
+		PoolStats stats = reg.stats<Health>();
+		MYECS_CHECK(stats.tombstones > 0);
+		MYECS_CHECK(reg.view<Health>().size() == live && stats.count == live);
+		size_t seen = 0;
+		for (entity e : reg.view<Health>()) {
+			MYECS_CHECK(reg.has<Health>(e));
+			seen++;
+		}
+		MYECS_CHECK(seen == live);
+
+		reg.sync();
+		MYECS_CHECK(reg.stats<Health>().tombstones == 0);
+		MYECS_CHECK(reg.view<Health>().size() == live && reg.view<Health>().extent() == live);
+		for (int i = 0; i < 1000; i++) {
+			if (reg.has<Health>(es[i])) {
+				MYECS_CHECK(reg.get<Health>(es[i]).value == i);
+			}
+		}
+	}
+
+	//insert purges the tombstones once they pass the compact ratio, not before
+	void purge_on_insert() {
+		SparseSet<entity> set;
+		set.set_deletion(DeletionPolicy::in_place(0.25f));
+		for (size_t i = 0; i < 100; i++) {
+			set.insert(entity(i, 0));
+		}
+		for (size_t i = 0; i < 20; i++) {
+			set.erase(entity(i * 2, 0));
+		}
+		set.insert(entity(100, 0));
+		//20 of 100 is below the ratio
+		MYECS_CHECK(set.tombstone_count() == 20 && set.size() == 81 && set.extent() == 101);
+		for (size_t i = 20; i < 30; i++) {
+			set.erase(entity(i * 2, 0));
+		}
+		MYECS_CHECK(set.tombstone_count() == 30 && set.size() == 71);
+		set.insert(entity(101, 0));
+		//30 of 101 passes it: purged before the insert
+		MYECS_CHECK(set.tombstone_count() == 0 && set.size() == 72 && set.extent() == 72);
+		for (size_t i = 0; i < 102; i++) {
+			bool erased = i < 60 && i % 2 == 0;
+			MYECS_CHECK(set.has(entity(i, 0)) == !erased);
+		}
+		size_t seen = 0;
+		for (entity e : set) {
+			MYECS_CHECK(set.has(e));
+			seen++;
+		}
+		MYECS_CHECK(seen == 72);
+	}
+}
+
+int main() {
+	destroy_inside_each();
+	purge_on_insert();
+	return 0;
+}